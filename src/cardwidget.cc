@@ -23,12 +23,14 @@
 #endif
 
 #include "cardwidget.h"
+#include "mainwindow.h"
 
 #include "i18n.h"
 
 /*** CardWidget ***/
 CardWidget::CardWidget(BaseObjectType* cobject, const Glib::RefPtr<Gtk::Builder>& x) :
-    Gtk::VBox(cobject) {
+    Gtk::VBox(cobject),
+    mpMainWindow(NULL) {
 
     x->get_widget("nameLabel", nameLabel);
     x->get_widget("profileList", profileList);
@@ -41,10 +43,11 @@ CardWidget::CardWidget(BaseObjectType* cobject, const Glib::RefPtr<Gtk::Builder>
     profileList->signal_changed().connect( sigc::mem_fun(*this, &CardWidget::onProfileChange));
 }
 
-CardWidget* CardWidget::create() {
+CardWidget* CardWidget::create(MainWindow* mainWindow) {
     CardWidget* w;
     Glib::RefPtr<Gtk::Builder> x = Gtk::Builder::create_from_file(GLADE_FILE, "cardWidget");
     x->get_widget_derived("cardWidget", w);
+    w->mpMainWindow = mainWindow;
     return w;
 }
 
@@ -83,6 +86,8 @@ void CardWidget::onProfileChange() {
           pa_operation* o;
           Glib::ustring profile = row[profileModel.name];
 
+          mpMainWindow->history.recordProfile(index, profile.c_str());
+
           if (!(o = pa_context_set_card_profile_by_index(get_context(), index, profile.c_str(), NULL, NULL))) {
               show_error(_("pa_context_set_card_profile_by_index() failed"));
               return;
@@ -23,10 +23,12 @@
 
 #include "pavucontrol.h"
 
+class MainWindow;
+
 class CardWidget : public Gtk::VBox {
 public:
     CardWidget(BaseObjectType* cobject, const Glib::RefPtr<Gtk::Builder>& x);
-    static CardWidget* create();
+    static CardWidget* create(MainWindow* mainWindow);
 
     Gtk::Label *nameLabel;
     Gtk::Menu menu;
@@ -59,6 +61,8 @@ protected:
 
   ModelColumns profileModel;
 
+  MainWindow *mpMainWindow;
+
   Gtk::ComboBox *profileList;
   Glib::RefPtr<Gtk::ListStore> treeModel;
 };
@@ -0,0 +1,65 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+
+#include "clientregistry.h"
+
+/*** ClientRegistry ***/
+void ClientRegistry::update(uint32_t index, const char *name) {
+    clients.insert(index).name = g_intern_string(name);
+}
+
+void ClientRegistry::remove(uint32_t index) {
+    clients.erase(index);
+}
+
+void ClientRegistry::clear() {
+    clients.clear();
+}
+
+const char* ClientRegistry::name(uint32_t index) {
+    Client *c = clients.find(index);
+
+    return c ? c->name : NULL;
+}
+
+const ClientRegistry::StreamSet* ClientRegistry::streams(uint32_t index) {
+    Client *c = clients.find(index);
+
+    return c ? &c->streams : NULL;
+}
+
+void ClientRegistry::attach(uint32_t index, StreamWidget *w) {
+    if (index == PA_INVALID_INDEX)
+        return;
+
+    clients.insert(index).streams.insert(w);
+}
+
+void ClientRegistry::detach(uint32_t index, StreamWidget *w) {
+    Client *c = clients.find(index);
+
+    if (c)
+        c->streams.erase(w);
+}
@@ -0,0 +1,60 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+
+#ifndef clientregistry_h
+#define clientregistry_h
+
+#include <set>
+
+#include "pavucontrol.h"
+#include "indexmap.h"
+
+class StreamWidget;
+
+/* Client names, interned since many clients share one, and the stream
+ * widgets currently showing each client so that a rename only has to
+ * touch those. Streams may be attached before their client is known. */
+class ClientRegistry {
+public:
+    typedef std::set<StreamWidget*> StreamSet;
+
+    void update(uint32_t index, const char *name);
+    void remove(uint32_t index);
+    void clear();
+
+    const char* name(uint32_t index);
+    const StreamSet* streams(uint32_t index);
+
+    void attach(uint32_t index, StreamWidget *w);
+    void detach(uint32_t index, StreamWidget *w);
+
+private:
+    struct Client {
+        Client() : name(NULL) {}
+
+        const char *name;
+        StreamSet streams;
+    };
+
+    IndexMap<Client> clients;
+};
+
+#endif
@@ -0,0 +1,102 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "cliplog.h"
+
+#include "i18n.h"
+
+/*** ClipLog ***/
+ClipLog::ClipLog() :
+    nextSerial(1),
+    dropped(0) {
+}
+
+ClipEvent *ClipLog::lookup(guint64 serial) {
+    if (serial == 0 || serial >= nextSerial || serial + CLIP_LOG_SIZE < nextSerial)
+        return NULL;
+
+    return &events[serial % CLIP_LOG_SIZE];
+}
+
+guint64 ClipLog::record(guint64 previous, const char *kind, uint32_t index, const Glib::ustring &name, unsigned readings) {
+    gint64 now = g_get_real_time();
+    ClipEvent *e;
+
+    /* Keep a burst of clipping on one object as a single event */
+    if ((e = lookup(previous)) && now - e->end < CLIP_EVENT_MERGE_USEC) {
+        e->end = now;
+        e->readings += readings;
+        return previous;
+    }
+
+    if (nextSerial > CLIP_LOG_SIZE)
+        dropped++;
+
+    e = &events[nextSerial % CLIP_LOG_SIZE];
+    e->serial = nextSerial;
+    e->start = e->end = now;
+    e->kind = kind;
+    e->index = index;
+    e->name = name;
+    e->readings = readings;
+
+    return nextSerial++;
+}
+
+static void format_time(char *buf, size_t l, gint64 t) {
+    GDateTime *dt;
+    gchar *s;
+
+    dt = g_date_time_new_from_unix_local(t / G_USEC_PER_SEC);
+    s = g_date_time_format(dt, "%Y-%m-%d %H:%M:%S");
+    snprintf(buf, l, "%s.%03u", s, (unsigned) ((t % G_USEC_PER_SEC) / 1000));
+    g_free(s);
+    g_date_time_unref(dt);
+}
+
+Glib::ustring ClipLog::toString() const {
+    Glib::ustring s;
+    char line[256], start[64], end[64];
+    guint64 first = nextSerial > CLIP_LOG_SIZE ? nextSerial - CLIP_LOG_SIZE : 1;
+
+    if (dropped > 0) {
+        snprintf(line, sizeof(line), _("# %lu older events were dropped\n"), dropped);
+        s += line;
+    }
+
+    s += "# start\tend\tkind\tindex\tclipped meter readings\tname\n";
+
+    for (guint64 serial = first; serial < nextSerial; serial++) {
+        const ClipEvent &e = events[serial % CLIP_LOG_SIZE];
+
+        format_time(start, sizeof(start), e.start);
+        format_time(end, sizeof(end), e.end);
+        snprintf(line, sizeof(line), "%s\t%s\t%s\t#%u\t%lu\t", start, end, e.kind, e.index, e.readings);
+        s += line;
+        s += e.name;
+        s += "\n";
+    }
+
+    return s;
+}
@@ -0,0 +1,58 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+#ifndef cliplog_h
+#define cliplog_h
+
+#include "pavucontrol.h"
+
+/* Number of overload events we remember before the oldest get dropped */
+#define CLIP_LOG_SIZE 512
+
+/* Clipping reported for the same object within this many usec is merged
+ * into the previous event */
+#define CLIP_EVENT_MERGE_USEC (1000 * 1000)
+
+struct ClipEvent {
+    guint64 serial;
+    gint64 start, end;
+    const char *kind;
+    uint32_t index;
+    Glib::ustring name;
+    unsigned long readings;
+};
+
+class ClipLog {
+public:
+    ClipLog();
+
+    guint64 record(guint64 previous, const char *kind, uint32_t index, const Glib::ustring &name, unsigned readings);
+
+    Glib::ustring toString() const;
+
+private:
+    ClipEvent events[CLIP_LOG_SIZE];
+    guint64 nextSerial;
+    unsigned long dropped;
+
+    ClipEvent *lookup(guint64 serial);
+};
+
+#endif
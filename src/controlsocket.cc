@@ -0,0 +1,875 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "controlsocket.h"
+#include "mainwindow.h"
+#include "jsonvalue.h"
+#include "jsonwriter.h"
+
+#include "i18n.h"
+
+/* Clients sending longer lines or not reading their replies are dropped */
+#define CONTROL_LINE_MAX (1024*1024)
+#define CONTROL_OUTPUT_MAX (1024*1024)
+
+/* JSON-RPC error codes */
+#define RPC_PARSE_ERROR -32700
+#define RPC_INVALID_REQUEST -32600
+#define RPC_METHOD_NOT_FOUND -32601
+#define RPC_INVALID_PARAMS -32602
+#define RPC_OPERATION_FAILED -32000
+
+enum ObjectType {
+    OBJECT_NONE = -1,
+    OBJECT_SINK,
+    OBJECT_SOURCE,
+    OBJECT_SINK_INPUT,
+    OBJECT_SOURCE_OUTPUT
+};
+
+static const VolumeFader::Kind fader_kinds[] = {
+    VolumeFader::SINK, VolumeFader::SOURCE, VolumeFader::SINK_INPUT, VolumeFader::SOURCE_OUTPUT
+};
+
+static ObjectType get_type(const JsonValue &params) {
+    static const char * const names[] = { "sink", "source", "sink_input", "source_output" };
+    const JsonValue *v = params.get("type");
+
+    if (v && v->isString())
+        for (unsigned i = 0; i < G_N_ELEMENTS(names); i++)
+            if (v->asString() == names[i])
+                return (ObjectType) i;
+
+    return OBJECT_NONE;
+}
+
+static bool get_index(const JsonValue &params, const char *key, uint32_t *idx) {
+    const JsonValue *v = params.get(key);
+
+    if (!v || !v->isNumber() || v->asNumber() < 0 || v->asNumber() >= PA_INVALID_INDEX || v->asNumber() != (uint32_t) v->asNumber())
+        return false;
+
+    *idx = (uint32_t) v->asNumber();
+    return true;
+}
+
+static bool get_volume(const JsonValue &v, pa_volume_t *volume) {
+    if (!v.isNumber() || v.asNumber() < 0 || v.asNumber() > PA_VOLUME_MAX)
+        return false;
+
+    *volume = (pa_volume_t) v.asNumber();
+    return true;
+}
+
+/* The volume params asks for, for the channels the object has */
+static bool get_target_volume(MainWindow *w, const JsonValue &params, ObjectType type, uint32_t idx, pa_cvolume *volume, const char **error) {
+    const JsonValue *v = params.get("volume");
+    uint8_t channels = 0;
+    pa_volume_t n;
+
+    switch (type) {
+        case OBJECT_SINK: {
+            pa_sink_info **i = w->sinkInfos.find(idx);
+            channels = i ? (*i)->volume.channels : 0;
+            break;
+        }
+        case OBJECT_SOURCE: {
+            pa_source_info **i = w->sourceInfos.find(idx);
+            channels = i ? (*i)->volume.channels : 0;
+            break;
+        }
+        case OBJECT_SINK_INPUT: {
+            pa_sink_input_info **i = w->sinkInputInfos.find(idx);
+            channels = i ? (*i)->volume.channels : 0;
+            break;
+        }
+        case OBJECT_SOURCE_OUTPUT: {
+            pa_source_output_info **i = w->sourceOutputInfos.find(idx);
+#if HAVE_SOURCE_OUTPUT_VOLUMES
+            channels = i ? (*i)->volume.channels : 0;
+#else
+            channels = i ? 1 : 0;
+#endif
+            break;
+        }
+        default:
+            break;
+    }
+
+    if (!channels) {
+        *error = "No such object";
+        return false;
+    }
+
+    /* One value for all channels, as with locked channels in the
+     * window, or one per channel */
+    if (v && get_volume(*v, &n))
+        pa_cvolume_set(volume, channels, n);
+    else if (v && v->isArray() && v->size() == channels) {
+        volume->channels = channels;
+        for (uint8_t i = 0; i < channels; i++)
+            if (!get_volume(*v->at(i), &volume->values[i])) {
+                *error = "Invalid volume";
+                return false;
+            }
+    } else {
+        *error = "volume must be a number or have one value per channel";
+        return false;
+    }
+
+    return true;
+}
+
+/*** ControlSocket ***/
+ControlSocket::ControlSocket(MainWindow *w) :
+    mpMainWindow(w),
+    mFd(-1),
+    nextClient(0) {
+}
+
+ControlSocket::~ControlSocket() {
+    stop();
+}
+
+bool ControlSocket::start() {
+    struct sockaddr_un sa;
+    gchar *dir, *path;
+    int fd;
+
+    if (mFd >= 0)
+        return true;
+
+    dir = g_build_filename(g_get_user_runtime_dir(), "pavucontrol", NULL);
+    path = g_build_filename(dir, "control", NULL);
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sun_family = AF_UNIX;
+
+    if (g_mkdir_with_parents(dir, 0700) < 0 || strlen(path) >= sizeof(sa.sun_path)) {
+        g_debug(_("Cannot create control socket in %s"), dir);
+        g_free(dir);
+        g_free(path);
+        return false;
+    }
+
+    g_strlcpy(sa.sun_path, path, sizeof(sa.sun_path));
+    g_free(dir);
+
+    if ((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+        g_free(path);
+        return false;
+    }
+
+    /* A socket nobody answers on is left over from a crashed instance,
+     * one that answers belongs to a running one */
+    if (connect(fd, (struct sockaddr*) &sa, sizeof(sa)) == 0) {
+        g_debug(_("Another instance is listening on %s"), path);
+        close(fd);
+        g_free(path);
+        return false;
+    }
+
+    if (errno == ECONNREFUSED)
+        unlink(path);
+
+    close(fd);
+
+    if ((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0 ||
+        fcntl(fd, F_SETFD, FD_CLOEXEC) < 0 ||
+        fcntl(fd, F_SETFL, O_NONBLOCK) < 0 ||
+        bind(fd, (struct sockaddr*) &sa, sizeof(sa)) < 0 ||
+        chmod(path, 0600) < 0 ||
+        listen(fd, 8) < 0) {
+
+        g_debug(_("Cannot listen on %s: %s"), path, g_strerror(errno));
+        if (fd >= 0)
+            close(fd);
+        g_free(path);
+        return false;
+    }
+
+    mFd = fd;
+    mPath = path;
+    g_free(path);
+
+    acceptConnection = Glib::signal_io().connect(sigc::mem_fun(*this, &ControlSocket::onAccept), mFd, Glib::IO_IN);
+
+    return true;
+}
+
+void ControlSocket::stop() {
+    if (mFd < 0)
+        return;
+
+    acceptConnection.disconnect();
+    dispatchConnection.disconnect();
+
+    while (!clients.empty())
+        closeClient(clients.begin()->first);
+
+    /* Queued calls still hold their batches, the answers have nowhere
+     * to go anymore */
+    std::vector<Call*> q;
+    q.swap(queue);
+    for (std::vector<Call*>::iterator i = q.begin(); i != q.end(); ++i)
+        finish(*i);
+
+    close(mFd);
+    mFd = -1;
+
+    unlink(mPath.c_str());
+    mPath.clear();
+}
+
+void ControlSocket::cancel() {
+    std::set<Call*> p;
+
+    p.swap(pending);
+    for (std::set<Call*>::iterator i = p.begin(); i != p.end(); ++i)
+        finish(*i, RPC_OPERATION_FAILED, "Connection to the sound server lost");
+}
+
+bool ControlSocket::onAccept(Glib::IOCondition) {
+    int fd;
+
+    while ((fd = accept(mFd, NULL, NULL)) >= 0) {
+        Client *c;
+        unsigned id = nextClient++;
+
+        if (fcntl(fd, F_SETFD, FD_CLOEXEC) < 0 || fcntl(fd, F_SETFL, O_NONBLOCK) < 0) {
+            close(fd);
+            continue;
+        }
+
+        c = new Client;
+        c->fd = fd;
+        c->eof = false;
+        c->batches = 0;
+        c->readConnection = Glib::signal_io().connect(sigc::bind(sigc::mem_fun(*this, &ControlSocket::onRead), id), fd, Glib::IO_IN | Glib::IO_HUP | Glib::IO_ERR);
+        clients[id] = c;
+    }
+
+    return true;
+}
+
+void ControlSocket::closeClient(unsigned id) {
+    std::map<unsigned, Client*>::iterator i = clients.find(id);
+
+    if (i == clients.end())
+        return;
+
+    /* Its outstanding calls still complete, their replies are dropped */
+    i->second->readConnection.disconnect();
+    i->second->writeConnection.disconnect();
+    close(i->second->fd);
+    delete i->second;
+    clients.erase(i);
+}
+
+/* A client that has stopped writing is closed once everything it asked
+ * for has been answered and sent */
+void ControlSocket::closeIfDone(unsigned id) {
+    std::map<unsigned, Client*>::iterator i = clients.find(id);
+
+    if (i == clients.end())
+        return;
+
+    if (i->second->eof && i->second->batches == 0 && i->second->out.empty())
+        closeClient(id);
+}
+
+bool ControlSocket::onRead(Glib::IOCondition, unsigned id) {
+    std::map<unsigned, Client*>::iterator i = clients.find(id);
+    char buf[4096];
+    ssize_t r;
+    size_t start, nl;
+
+    if (i == clients.end())
+        return false;
+
+    Client *c = i->second;
+
+    while ((r = read(c->fd, buf, sizeof(buf))) > 0)
+        c->in.append(buf, r);
+
+    if (r < 0 && errno != EAGAIN && errno != EINTR) {
+        closeClient(id);
+        return false;
+    }
+
+    for (start = 0; (nl = c->in.find('\n', start)) != std::string::npos; start = nl + 1)
+        if (nl > start) {
+            receive(id, c->in.substr(start, nl - start));
+
+            /* Answering a parse error may have dropped the client */
+            if (clients.find(id) == clients.end())
+                return false;
+        }
+
+    c->in.erase(0, start);
+
+    /* Half-closed after writing its requests, they are still answered and
+     * an unterminated last line is dropped */
+    if (r == 0) {
+        c->eof = true;
+        c->in.clear();
+        closeIfDone(id);
+        return false;
+    }
+
+    if (c->in.size() > CONTROL_LINE_MAX) {
+        closeClient(id);
+        return false;
+    }
+
+    return true;
+}
+
+bool ControlSocket::onWrite(Glib::IOCondition, unsigned id) {
+    std::map<unsigned, Client*>::iterator i = clients.find(id);
+    ssize_t r;
+
+    if (i == clients.end())
+        return false;
+
+    Client *c = i->second;
+
+    while (!c->out.empty() && (r = ::send(c->fd, c->out.data(), c->out.size(), MSG_NOSIGNAL)) > 0)
+        c->out.erase(0, r);
+
+    if (c->out.empty()) {
+        closeIfDone(id);
+        return false;
+    }
+
+    if (errno != EAGAIN && errno != EINTR) {
+        closeClient(id);
+        return false;
+    }
+
+    return true;
+}
+
+void ControlSocket::send(unsigned id, const std::string &s) {
+    std::map<unsigned, Client*>::iterator i = clients.find(id);
+
+    if (i == clients.end())
+        return;
+
+    Client *c = i->second;
+
+    c->out += s;
+
+    if (c->out.size() > CONTROL_OUTPUT_MAX) {
+        closeClient(id);
+        return;
+    }
+
+    if (c->writeConnection.connected())
+        return;
+
+    if (onWrite(Glib::IO_OUT, id))
+        c->writeConnection = Glib::signal_io().connect(sigc::bind(sigc::mem_fun(*this, &ControlSocket::onWrite), id), c->fd, Glib::IO_OUT);
+}
+
+void ControlSocket::receive(unsigned id, const std::string &line) {
+    std::string error;
+    JsonValue *root;
+    Batch *b;
+
+    if (!(root = JsonValue::parse(line, &error))) {
+        JsonWriter w;
+
+        w.beginObject();
+        w.member("jsonrpc", "2.0");
+        w.key("id");
+        w.null();
+        w.key("error");
+        w.beginObject();
+        w.key("code");
+        w.number((long long) RPC_PARSE_ERROR);
+        w.member("message", error.c_str());
+        w.endObject();
+        w.endObject();
+        w.endLine();
+
+        send(id, w.buffer());
+        return;
+    }
+
+    b = new Batch;
+    b->client = id;
+    b->array = root->isArray() && root->size() > 0;
+    b->outstanding = 0;
+    b->root = root;
+    clients[id]->batches++;
+
+    /* An empty batch is answered like any other invalid request */
+    if (!b->array)
+        enqueue(b, root);
+    else
+        for (size_t i = 0; i < root->size(); i++)
+            enqueue(b, root->at(i));
+}
+
+void ControlSocket::enqueue(Batch *b, const JsonValue *request) {
+    Call *call = new Call;
+    const JsonValue *id = request->isObject() ? request->get("id") : NULL;
+
+    call->socket = this;
+    call->batch = b;
+    call->request = request;
+
+    /* Requests without an id are notifications and get no answer, but
+     * something that is not a request at all is answered with a null id */
+    call->notification = request->isObject() && !id;
+
+    if (id) {
+        JsonWriter w;
+        id->write(w);
+        call->id = w.buffer();
+    } else
+        call->id = "null";
+
+    b->outstanding++;
+    queue.push_back(call);
+
+    if (!dispatchConnection.connected())
+        dispatchConnection = Glib::signal_idle().connect(sigc::mem_fun(*this, &ControlSocket::onDispatch));
+}
+
+bool ControlSocket::onDispatch() {
+    std::vector<Call*> q;
+
+    /* Everything that arrived since the last time goes out in one go */
+    q.swap(queue);
+    for (std::vector<Call*>::iterator i = q.begin(); i != q.end(); ++i)
+        execute(*i);
+
+    return false;
+}
+
+void ControlSocket::execute(Call *call) {
+    static const JsonValue noParams(JsonValue::JSON_OBJECT);
+    const JsonValue *request = call->request, *method, *params;
+    const char *error = NULL;
+    pa_context *c = get_context();
+    pa_operation *o;
+
+    if (!request->isObject() || !(method = request->get("method")) || !method->isString()) {
+        finish(call, RPC_INVALID_REQUEST, "Invalid request");
+        return;
+    }
+
+    if (!(params = request->get("params")))
+        params = &noParams;
+    else if (!params->isObject()) {
+        finish(call, RPC_INVALID_PARAMS, "params must be an object");
+        return;
+    }
+
+    if (!c || pa_context_get_state(c) != PA_CONTEXT_READY) {
+        finish(call, RPC_OPERATION_FAILED, "Not connected to the sound server");
+        return;
+    }
+
+    const std::string &m = method->asString();
+
+    if (m == "set_volume")
+        o = setVolume(*params, call, &error);
+    else if (m == "set_mute")
+        o = setMute(*params, call, &error);
+    else if (m == "move")
+        o = move(*params, call, &error);
+    else if (m == "set_card_profile")
+        o = setCardProfile(*params, call, &error);
+    else if (m == "set_default")
+        o = setDefault(*params, call, &error);
+    else if (m == "save_snapshot") {
+        saveSnapshot(*params, call);
+        return;
+    } else if (m == "restore_snapshot") {
+        restoreSnapshot(*params, call);
+        return;
+    } else if (m == "fade") {
+        fade(*params, call);
+        return;
+    } else {
+        finish(call, RPC_METHOD_NOT_FOUND, "Method not found");
+        return;
+    }
+
+    if (!o) {
+        if (error)
+            finish(call, RPC_INVALID_PARAMS, error);
+        else
+            finish(call, RPC_OPERATION_FAILED, pa_strerror(pa_context_errno(c)));
+        return;
+    }
+
+    pending.insert(call);
+    pa_operation_unref(o);
+}
+
+void ControlSocket::success_cb(pa_context *c, int success, void *userdata) {
+    Call *call = static_cast<Call*>(userdata);
+    ControlSocket *s = call->socket;
+
+    if (success)
+        s->finish(call);
+    else
+        s->finish(call, RPC_OPERATION_FAILED, pa_strerror(pa_context_errno(c)));
+}
+
+void ControlSocket::finish(Call *call, int code, const char *message) {
+    std::map<unsigned, Client*>::iterator client;
+    Batch *b = call->batch;
+
+    if (!call->notification) {
+        JsonWriter w;
+
+        w.beginObject();
+        w.member("jsonrpc", "2.0");
+        w.key("id");
+        w.raw(call->id);
+
+        if (message) {
+            w.key("error");
+            w.beginObject();
+            w.key("code");
+            w.number((long long) code);
+            w.member("message", message);
+            w.endObject();
+        } else
+            w.member("result", true);
+
+        w.endObject();
+        b->responses.push_back(w.buffer());
+    }
+
+    pending.erase(call);
+    delete call;
+
+    if (--b->outstanding > 0)
+        return;
+
+    if ((client = clients.find(b->client)) != clients.end())
+        client->second->batches--;
+
+    if (!b->responses.empty()) {
+        std::string s;
+
+        if (b->array)
+            s += '[';
+        for (size_t i = 0; i < b->responses.size(); i++) {
+            if (i > 0)
+                s += ',';
+            s += b->responses[i];
+        }
+        if (b->array)
+            s += ']';
+        s += '\n';
+
+        send(b->client, s);
+    }
+
+    closeIfDone(b->client);
+
+    delete b->root;
+    delete b;
+}
+
+pa_operation* ControlSocket::setVolume(const JsonValue &params, Call *call, const char **error) {
+    ObjectType type = get_type(params);
+    uint32_t idx;
+    pa_cvolume volume;
+
+    if (type == OBJECT_NONE || !get_index(params, "index", &idx)) {
+        *error = "Expected type and index";
+        return NULL;
+    }
+
+    if (!get_target_volume(mpMainWindow, params, type, idx, &volume, error))
+        return NULL;
+
+    /* Its next step would overwrite the volume we set */
+    mpMainWindow->fader.cancel(fader_kinds[type], idx);
+
+    switch (type) {
+        case OBJECT_SINK:
+            return pa_context_set_sink_volume_by_index(get_context(), idx, &volume, success_cb, call);
+        case OBJECT_SOURCE:
+            return pa_context_set_source_volume_by_index(get_context(), idx, &volume, success_cb, call);
+        case OBJECT_SINK_INPUT:
+            return pa_context_set_sink_input_volume(get_context(), idx, &volume, success_cb, call);
+        case OBJECT_SOURCE_OUTPUT:
+#if HAVE_SOURCE_OUTPUT_VOLUMES
+            return pa_context_set_source_output_volume(get_context(), idx, &volume, success_cb, call);
+#endif
+        default:
+            *error = "Recording streams have no volume with this server";
+            return NULL;
+    }
+}
+
+pa_operation* ControlSocket::setMute(const JsonValue &params, Call *call, const char **error) {
+    ObjectType type = get_type(params);
+    const JsonValue *v = params.get("mute");
+    bool found = false;
+    uint32_t idx;
+
+    if (type == OBJECT_NONE || !get_index(params, "index", &idx) || !v || !v->isBoolean()) {
+        *error = "Expected type, index and mute";
+        return NULL;
+    }
+
+    switch (type) {
+        case OBJECT_SINK:
+            found = mpMainWindow->sinkInfos.find(idx) != NULL;
+            break;
+        case OBJECT_SOURCE:
+            found = mpMainWindow->sourceInfos.find(idx) != NULL;
+            break;
+        case OBJECT_SINK_INPUT:
+            found = mpMainWindow->sinkInputInfos.find(idx) != NULL;
+            break;
+        case OBJECT_SOURCE_OUTPUT:
+            found = mpMainWindow->sourceOutputInfos.find(idx) != NULL;
+            break;
+        default:
+            break;
+    }
+
+    if (!found) {
+        *error = "No such object";
+        return NULL;
+    }
+
+    mpMainWindow->fader.cancel(fader_kinds[type], idx);
+
+    switch (type) {
+        case OBJECT_SINK:
+            return pa_context_set_sink_mute_by_index(get_context(), idx, v->asBoolean(), success_cb, call);
+        case OBJECT_SOURCE:
+            return pa_context_set_source_mute_by_index(get_context(), idx, v->asBoolean(), success_cb, call);
+        case OBJECT_SINK_INPUT:
+            return pa_context_set_sink_input_mute(get_context(), idx, v->asBoolean(), success_cb, call);
+        case OBJECT_SOURCE_OUTPUT:
+#if HAVE_SOURCE_OUTPUT_VOLUMES
+            return pa_context_set_source_output_mute(get_context(), idx, v->asBoolean(), success_cb, call);
+#endif
+        default:
+            *error = "Recording streams cannot be muted with this server";
+            return NULL;
+    }
+}
+
+pa_operation* ControlSocket::move(const JsonValue &params, Call *call, const char **error) {
+    ObjectType type = get_type(params);
+    uint32_t idx, device;
+
+    if (!get_index(params, "index", &idx) || !get_index(params, "device", &device)) {
+        *error = "Expected type, index and device";
+        return NULL;
+    }
+
+    if (type == OBJECT_SINK_INPUT) {
+        if (!mpMainWindow->sinkInputInfos.find(idx) || !mpMainWindow->sinkInfos.find(device)) {
+            *error = "No such object";
+            return NULL;
+        }
+
+        return pa_context_move_sink_input_by_index(get_context(), idx, device, success_cb, call);
+    }
+
+    if (type == OBJECT_SOURCE_OUTPUT) {
+        if (!mpMainWindow->sourceOutputInfos.find(idx) || !mpMainWindow->sourceInfos.find(device)) {
+            *error = "No such object";
+            return NULL;
+        }
+
+        return pa_context_move_source_output_by_index(get_context(), idx, device, success_cb, call);
+    }
+
+    *error = "Only sink_input and source_output can be moved";
+    return NULL;
+}
+
+pa_operation* ControlSocket::setCardProfile(const JsonValue &params, Call *call, const char **error) {
+    const JsonValue *profile = params.get("profile");
+    uint32_t idx;
+
+    if (!get_index(params, "index", &idx) || !profile || !profile->isString()) {
+        *error = "Expected index and profile";
+        return NULL;
+    }
+
+    if (!mpMainWindow->cardInfos.find(idx)) {
+        *error = "No such object";
+        return NULL;
+    }
+
+    return pa_context_set_card_profile_by_index(get_context(), idx, profile->asString().c_str(), success_cb, call);
+}
+
+pa_operation* ControlSocket::setDefault(const JsonValue &params, Call *call, const char **error) {
+    ObjectType type = get_type(params);
+    uint32_t idx;
+
+    if (!get_index(params, "index", &idx)) {
+        *error = "Expected type and index";
+        return NULL;
+    }
+
+    /* The server wants the name, the window remembers it by index */
+    if (type == OBJECT_SINK) {
+        pa_sink_info **i = mpMainWindow->sinkInfos.find(idx);
+
+        if (!i) {
+            *error = "No such object";
+            return NULL;
+        }
+
+        return pa_context_set_default_sink(get_context(), (*i)->name, success_cb, call);
+    }
+
+    if (type == OBJECT_SOURCE) {
+        pa_source_info **i = mpMainWindow->sourceInfos.find(idx);
+
+        if (!i) {
+            *error = "No such object";
+            return NULL;
+        }
+
+        return pa_context_set_default_source(get_context(), (*i)->name, success_cb, call);
+    }
+
+    *error = "Only sink and source can be the default";
+    return NULL;
+}
+
+void ControlSocket::saveSnapshot(const JsonValue &params, Call *call) {
+    const JsonValue *path = params.get("path");
+    GError *err = NULL;
+
+    if (!path || !path->isString()) {
+        finish(call, RPC_INVALID_PARAMS, "Expected path");
+        return;
+    }
+
+    std::string data = mpMainWindow->snapshot.capture();
+
+    if (!g_file_set_contents(path->asString().c_str(), data.c_str(), data.size(), &err)) {
+        finish(call, RPC_OPERATION_FAILED, err->message);
+        g_error_free(err);
+        return;
+    }
+
+    finish(call);
+}
+
+void ControlSocket::restoreSnapshot(const JsonValue &params, Call *call) {
+    const JsonValue *path = params.get("path");
+    GError *err = NULL;
+    std::string error;
+    gchar *data;
+    gsize length;
+    bool ok;
+
+    if (!path || !path->isString()) {
+        finish(call, RPC_INVALID_PARAMS, "Expected path");
+        return;
+    }
+
+    if (!g_file_get_contents(path->asString().c_str(), &data, &length, &err)) {
+        finish(call, RPC_OPERATION_FAILED, err->message);
+        g_error_free(err);
+        return;
+    }
+
+    /* Answered from onSnapshotRestored(), which may run right away */
+    pending.insert(call);
+    ok = mpMainWindow->snapshot.restore(std::string(data, length), sigc::bind(sigc::mem_fun(*this, &ControlSocket::onSnapshotRestored), call), &error);
+    g_free(data);
+
+    if (!ok)
+        finish(call, RPC_INVALID_PARAMS, error.c_str());
+}
+
+void ControlSocket::onSnapshotRestored(unsigned operations, unsigned failed, Call *call) {
+    gchar *txt;
+
+    if (failed == 0) {
+        finish(call);
+        return;
+    }
+
+    txt = g_strdup_printf("%u of %u operations failed", failed, operations);
+    finish(call, RPC_OPERATION_FAILED, txt);
+    g_free(txt);
+}
+
+void ControlSocket::fade(const JsonValue &params, Call *call) {
+    ObjectType type = get_type(params);
+    const JsonValue *duration = params.get("duration");
+    const char *error = NULL;
+    pa_cvolume volume;
+    uint32_t idx;
+
+    if (type == OBJECT_NONE || !get_index(params, "index", &idx)) {
+        finish(call, RPC_INVALID_PARAMS, "Expected type and index");
+        return;
+    }
+
+    if (!duration || !duration->isNumber() || duration->asNumber() < 0 || duration->asNumber() > 600000) {
+        finish(call, RPC_INVALID_PARAMS, "duration must be between 0 and 600000 ms");
+        return;
+    }
+
+    if (!get_target_volume(mpMainWindow, params, type, idx, &volume, &error)) {
+        finish(call, RPC_INVALID_PARAMS, error);
+        return;
+    }
+
+    /* Answered from onFadeDone() once the ramp ends */
+    pending.insert(call);
+    if (!mpMainWindow->fader.fade(fader_kinds[type], idx, volume, (unsigned) duration->asNumber(), sigc::bind(sigc::mem_fun(*this, &ControlSocket::onFadeDone), call)))
+        finish(call, RPC_OPERATION_FAILED, "Recording streams have no volume with this server");
+}
+
+void ControlSocket::onFadeDone(bool ok, Call *call) {
+    if (ok)
+        finish(call);
+    else
+        finish(call, RPC_OPERATION_FAILED, "Fade cancelled or failed");
+}
@@ -0,0 +1,117 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+
+#ifndef controlsocket_h
+#define controlsocket_h
+
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+
+#include "pavucontrol.h"
+
+class MainWindow;
+class JsonValue;
+
+/* Accepts JSON-RPC 2.0 calls on a Unix socket, one request or batch per
+ * line, and turns them into the same operations the widgets issue. All
+ * requests read in one main loop iteration are sent to the server
+ * together from an idle callback, and each is answered once the server
+ * has completed its operation. */
+class ControlSocket {
+public:
+    ControlSocket(MainWindow *w);
+    ~ControlSocket();
+
+    /* Listens on $XDG_RUNTIME_DIR/pavucontrol/control unless another
+     * instance already does */
+    bool start();
+    void stop();
+
+    /* Fails the calls still waiting for the server, their operations
+     * died with the connection */
+    void cancel();
+
+private:
+    struct Client {
+        int fd;
+        std::string in, out;
+        sigc::connection readConnection, writeConnection;
+        bool eof;
+        unsigned batches;
+    };
+
+    /* The requests from one line, answered together */
+    struct Batch {
+        unsigned client;
+        bool array;
+        unsigned outstanding;
+        JsonValue *root;
+        std::vector<std::string> responses;
+    };
+
+    struct Call {
+        ControlSocket *socket;
+        Batch *batch;
+        const JsonValue *request;
+        std::string id;
+        bool notification;
+    };
+
+    MainWindow *mpMainWindow;
+    int mFd;
+    std::string mPath;
+    sigc::connection acceptConnection, dispatchConnection;
+
+    unsigned nextClient;
+    std::map<unsigned, Client*> clients;
+    std::vector<Call*> queue;
+    std::set<Call*> pending;
+
+    bool onAccept(Glib::IOCondition condition);
+    bool onRead(Glib::IOCondition condition, unsigned id);
+    bool onWrite(Glib::IOCondition condition, unsigned id);
+    void closeClient(unsigned id);
+    void closeIfDone(unsigned id);
+    void send(unsigned id, const std::string &s);
+
+    void receive(unsigned id, const std::string &line);
+    void enqueue(Batch *b, const JsonValue *request);
+    bool onDispatch();
+    void execute(Call *call);
+    void finish(Call *call, int code = 0, const char *message = NULL);
+
+    pa_operation* setVolume(const JsonValue &params, Call *call, const char **error);
+    pa_operation* setMute(const JsonValue &params, Call *call, const char **error);
+    pa_operation* move(const JsonValue &params, Call *call, const char **error);
+    pa_operation* setCardProfile(const JsonValue &params, Call *call, const char **error);
+    pa_operation* setDefault(const JsonValue &params, Call *call, const char **error);
+    void saveSnapshot(const JsonValue &params, Call *call);
+    void restoreSnapshot(const JsonValue &params, Call *call);
+    void onSnapshotRestored(unsigned operations, unsigned failed, Call *call);
+    void fade(const JsonValue &params, Call *call);
+    void onFadeDone(bool ok, Call *call);
+
+    static void success_cb(pa_context *c, int success, void *userdata);
+};
+
+#endif
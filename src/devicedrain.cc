@@ -0,0 +1,144 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+
+#include "devicedrain.h"
+#include "mainwindow.h"
+#include "operationbatch.h"
+
+#include "i18n.h"
+
+/*** DeviceDrain ***/
+std::set<DeviceDrain*> DeviceDrain::drains;
+
+DeviceDrain::DeviceDrain(MainWindow *w, bool recording) :
+    mpMainWindow(w),
+    mRecording(recording) {
+
+    mBatch = new OperationBatch(sigc::mem_fun(*this, &DeviceDrain::finish));
+    drains.insert(this);
+}
+
+DeviceDrain::~DeviceDrain() {
+    delete mBatch;
+    drains.erase(this);
+}
+
+void DeviceDrain::start(MainWindow *w, bool recording, uint32_t from, uint32_t to) {
+    std::set<uint32_t> *streams;
+    DeviceDrain *d;
+
+    if (from == to)
+        return;
+
+    /* The streams are looked up by device, no need to go through all of
+     * them */
+    streams = recording ? w->sourceOutputsBySource.find(from) : w->sinkInputsBySink.find(from);
+    if (!streams || streams->empty())
+        return;
+
+    d = new DeviceDrain(w, recording);
+
+    w->history.beginGroup();
+    for (std::set<uint32_t>::iterator i = streams->begin(); i != streams->end(); ++i) {
+        /* Named now, the most common failure is the stream going away,
+         * and by the time the reply comes we no longer know it */
+        void *userdata = d->mBatch->next(d->streamName(*i));
+
+        w->history.recordMove(recording ? UndoHistory::SOURCE_OUTPUT : UndoHistory::SINK_INPUT, *i, to);
+
+        if (recording)
+            d->mBatch->issue(pa_context_move_source_output_by_index(get_context(), *i, to, OperationBatch::success_cb, userdata));
+        else
+            d->mBatch->issue(pa_context_move_sink_input_by_index(get_context(), *i, to, OperationBatch::success_cb, userdata));
+    }
+    w->history.endGroup();
+
+    d->mBatch->end();
+}
+
+void DeviceDrain::cancel() {
+    while (!drains.empty())
+        delete *drains.begin();
+}
+
+std::string DeviceDrain::streamName(uint32_t stream) {
+    const char *name = NULL, *client = NULL;
+    gchar *txt;
+    std::string r;
+
+    if (mRecording) {
+        pa_source_output_info **info = mpMainWindow->sourceOutputInfos.find(stream);
+        if (info) {
+            name = (*info)->name;
+            client = mpMainWindow->clients.name((*info)->client);
+        }
+    } else {
+        pa_sink_input_info **info = mpMainWindow->sinkInputInfos.find(stream);
+        if (info) {
+            name = (*info)->name;
+            client = mpMainWindow->clients.name((*info)->client);
+        }
+    }
+
+    if (client)
+        txt = g_strdup_printf("%s: %s (#%u)", client, name, stream);
+    else
+        txt = g_strdup_printf("%s (#%u)", name ? name : _("Unknown stream"), stream);
+
+    r = txt;
+    g_free(txt);
+    return r;
+}
+
+void DeviceDrain::finish(OperationBatch *b) {
+    const std::vector<std::string> &failures = b->failures();
+
+    /* Out of reach of cancel() while the dialog runs its own loop, the
+     * batch deletes itself once we return */
+    drains.erase(this);
+    mBatch = NULL;
+
+    if (!failures.empty()) {
+        std::string text;
+
+        for (size_t i = 0; i < failures.size(); i++) {
+            if (i > 0)
+                text += '\n';
+            text += failures[i];
+        }
+
+        Gtk::MessageDialog dialog(
+            *mpMainWindow,
+            mRecording ? _("Some streams could not be moved off the input device.") : _("Some streams could not be moved off the output device."),
+            false,
+            Gtk::MESSAGE_WARNING,
+            Gtk::BUTTONS_OK,
+            true);
+        dialog.set_secondary_text(text);
+        dialog.run();
+    }
+
+    delete this;
+}
@@ -0,0 +1,59 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+
+#ifndef devicedrain_h
+#define devicedrain_h
+
+#include <set>
+#include <string>
+
+#include "pavucontrol.h"
+
+class MainWindow;
+class OperationBatch;
+
+/* Moves every stream off one sink or source, for instance before the
+ * hardware is unplugged. All moves are sent at once, and the streams that
+ * could not be moved are listed when the last one has completed. The
+ * object deletes itself when done. */
+class DeviceDrain {
+public:
+    static void start(MainWindow *w, bool recording, uint32_t from, uint32_t to);
+
+    /* Drops the drains still waiting for the server, their callbacks
+     * never come once the connection is gone */
+    static void cancel();
+
+private:
+    DeviceDrain(MainWindow *w, bool recording);
+    ~DeviceDrain();
+
+    static std::set<DeviceDrain*> drains;
+
+    MainWindow *mpMainWindow;
+    bool mRecording;
+    OperationBatch *mBatch;
+
+    std::string streamName(uint32_t stream);
+    void finish(OperationBatch *b);
+};
+
+#endif
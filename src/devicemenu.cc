@@ -0,0 +1,104 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+
+#include "devicemenu.h"
+
+/*** DeviceMenu ***/
+DeviceMenu::DeviceMenu() :
+    mActive(PA_INVALID_INDEX),
+    updating(false) {
+}
+
+DeviceMenu::~DeviceMenu() {
+    clear();
+}
+
+void DeviceMenu::update(uint32_t index, const char *description) {
+    bool is_new;
+    Item *&item = items.insert(index, &is_new);
+
+    if (!is_new) {
+        item->menuItem.set_label(description);
+        return;
+    }
+
+    item = new Item(this, description, index);
+    menu.append(item->menuItem);
+    item->menuItem.show();
+}
+
+void DeviceMenu::remove(uint32_t index) {
+    Item **item;
+
+    if (!(item = items.find(index)))
+        return;
+
+    if (index == mActive)
+        mActive = PA_INVALID_INDEX;
+
+    delete *item;
+    items.erase(index);
+}
+
+void DeviceMenu::clear() {
+    for (IndexMap<Item*>::iterator i = items.begin(); i != items.end(); ++i)
+        delete i->second;
+
+    items.clear();
+    mActive = PA_INVALID_INDEX;
+}
+
+void DeviceMenu::setActive(uint32_t index) {
+    Item **item;
+
+    updating = true;
+
+    if ((item = items.find(mActive)))
+        (*item)->menuItem.set_active(false);
+
+    mActive = index;
+
+    if ((item = items.find(mActive)))
+        (*item)->menuItem.set_active(true);
+
+    updating = false;
+}
+
+void DeviceMenu::popup(uint32_t current, const sigc::slot<void,uint32_t> &onSelect) {
+    selectSlot = onSelect;
+    setActive(current);
+    menu.popup(1, 0);
+}
+
+void DeviceMenu::Item::onToggle() {
+    if (menu->updating)
+        return;
+
+    if (!menuItem.get_active())
+        return;
+
+    menu->setActive(index);
+    menu->selectSlot(index);
+}
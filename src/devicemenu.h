@@ -0,0 +1,67 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+
+#ifndef devicemenu_h
+#define devicemenu_h
+
+#include "pavucontrol.h"
+#include "indexmap.h"
+
+/* The "move to device" popup of the stream widgets. There is one per
+ * direction, kept in sync with the devices as they come and go, and only
+ * the check marks and the stream to move are set up on popup. */
+class DeviceMenu {
+public:
+    DeviceMenu();
+    ~DeviceMenu();
+
+    void update(uint32_t index, const char *description);
+    void remove(uint32_t index);
+    void clear();
+
+    void popup(uint32_t current, const sigc::slot<void,uint32_t> &onSelect);
+
+private:
+    struct Item {
+        Item(DeviceMenu *m, const char *label, uint32_t i) :
+            menu(m),
+            menuItem(label),
+            index(i) {
+            menuItem.set_draw_as_radio(true);
+            menuItem.signal_toggled().connect(sigc::mem_fun(*this, &Item::onToggle));
+        }
+
+        DeviceMenu *menu;
+        Gtk::CheckMenuItem menuItem;
+        uint32_t index;
+        void onToggle();
+    };
+
+    Gtk::Menu menu;
+    IndexMap<Item*> items;
+    uint32_t mActive;
+    bool updating;
+    sigc::slot<void,uint32_t> selectSlot;
+
+    void setActive(uint32_t index);
+};
+
+#endif
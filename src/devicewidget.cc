@@ -32,7 +32,10 @@
 
 /*** DeviceWidget ***/
 DeviceWidget::DeviceWidget(BaseObjectType* cobject, const Glib::RefPtr<Gtk::Builder>& x) :
-    MinimalStreamWidget(cobject, x)  {
+    MinimalStreamWidget(cobject, x),
+    allChannelsWidget(NULL),
+    canDecibel(false),
+    baseVolume(PA_VOLUME_NORM) {
 
     x->get_widget("lockToggleButton", lockToggleButton);
     x->get_widget("muteToggleButton", muteToggleButton);
@@ -44,11 +47,18 @@ DeviceWidget::DeviceWidget(BaseObjectType* cobject, const Glib::RefPtr<Gtk::Buil
 
     this->signal_button_press_event().connect(sigc::mem_fun(*this, &DeviceWidget::onContextTriggerEvent));
     muteToggleButton->signal_clicked().connect(sigc::mem_fun(*this, &DeviceWidget::onMuteToggleButton));
+    lockToggleButton->signal_toggled().connect(sigc::mem_fun(*this, &DeviceWidget::onLockToggleButton));
     defaultToggleButton->signal_clicked().connect(sigc::mem_fun(*this, &DeviceWidget::onDefaultToggleButton));
 
     rename.set_label(_("Rename Device..."));
     rename.signal_activate().connect(sigc::mem_fun(*this, &DeviceWidget::renamePopup));
     contextMenu.append(rename);
+    drain.set_label(_("Move All Streams To..."));
+    drain.signal_activate().connect(sigc::mem_fun(*this, &DeviceWidget::onDrainPopup));
+    contextMenu.append(drain);
+    saveClipLog.set_label(_("Save Clip Log..."));
+    saveClipLog.signal_activate().connect(sigc::mem_fun(*this, &DeviceWidget::onSaveClipLog));
+    contextMenu.append(saveClipLog);
     contextMenu.show_all();
 
     treeModel = Gtk::ListStore::create(portModel);
@@ -70,22 +80,68 @@ void DeviceWidget::init(MainWindow* mainWindow, Glib::ustring deviceType) {
     mDeviceType = deviceType;
 }
 
+ChannelWidget* DeviceWidget::createChannelWidget(int channel, const char *label, bool last) {
+    ChannelWidget *cw = ChannelWidget::create();
+    char text[64];
+
+    cw->channel = channel;
+    cw->can_decibel = canDecibel;
+    cw->minimalStreamWidget = this;
+    cw->last = last;
+    snprintf(text, sizeof(text), "<b>%s</b>", label);
+    cw->channelLabel->set_markup(text);
+    cw->setBaseVolume(baseVolume);
+    cw->set_sensitive(!muteToggleButton->get_active());
+    channelsVBox->pack_start(*cw, false, false, 0);
+
+    return cw;
+}
+
 void DeviceWidget::setChannelMap(const pa_channel_map &m, bool can_decibel) {
     channelMap = m;
+    canDecibel = can_decibel;
+    pa_cvolume_reset(&volume, m.channels);
 
-    for (int i = 0; i < m.channels; i++) {
-        ChannelWidget *cw = channelWidgets[i] = ChannelWidget::create();
-        cw->channel = i;
-        cw->can_decibel = can_decibel;
-        cw->minimalStreamWidget = this;
-        char text[64];
-        snprintf(text, sizeof(text), "<b>%s</b>", pa_channel_position_to_pretty_string(m.map[i]));
-        cw->channelLabel->set_markup(text);
-        channelsVBox->pack_start(*cw, false, false, 0);
-    }
-    channelWidgets[m.channels-1]->last = true;
+    /* Locked channels all move together, so they get a single slider until
+     * the user unlocks them */
+    if (m.channels > 1)
+        allChannelsWidget = createChannelWidget(0, _("All Channels"), true);
 
     lockToggleButton->set_sensitive(m.channels > 1);
+
+    updateChannelView();
+}
+
+void DeviceWidget::updateChannelView() {
+    bool collapsed = allChannelsWidget && lockToggleButton->get_active();
+
+    if (!collapsed && !channelWidgets[0]) {
+        for (int i = 0; i < channelMap.channels; i++) {
+            channelWidgets[i] = createChannelWidget(i, pa_channel_position_to_pretty_string(channelMap.map[i]), i == channelMap.channels - 1);
+            channelWidgets[i]->setVolume(volume.values[i]);
+        }
+    }
+
+    if (allChannelsWidget) {
+        if (collapsed)
+            allChannelsWidget->show();
+        else
+            allChannelsWidget->hide();
+    }
+
+    for (int i = 0; i < channelMap.channels; i++) {
+        if (!channelWidgets[i])
+            continue;
+
+        if (collapsed)
+            channelWidgets[i]->hide();
+        else
+            channelWidgets[i]->show();
+    }
+}
+
+void DeviceWidget::onLockToggleButton() {
+    updateChannelView();
 }
 
 void DeviceWidget::setVolume(const pa_cvolume &v, bool force) {
@@ -94,8 +150,12 @@ void DeviceWidget::setVolume(const pa_cvolume &v, bool force) {
     volume = v;
 
     if (timeoutConnection.empty() || force) { /* do not update the volume when a volume change is still in flux */
+        if (allChannelsWidget)
+            allChannelsWidget->setVolume(pa_cvolume_max(&volume));
+
         for (int i = 0; i < volume.channels; i++)
-            channelWidgets[i]->setVolume(volume.values[i]);
+            if (channelWidgets[i])
+                channelWidgets[i]->setVolume(volume.values[i]);
     }
 }
 
@@ -119,8 +179,12 @@ void DeviceWidget::onMuteToggleButton() {
 
     lockToggleButton->set_sensitive(!muteToggleButton->get_active());
 
+    if (allChannelsWidget)
+        allChannelsWidget->set_sensitive(!muteToggleButton->get_active());
+
     for (int i = 0; i < channelMap.channels; i++)
-        channelWidgets[i]->set_sensitive(!muteToggleButton->get_active());
+        if (channelWidgets[i])
+            channelWidgets[i]->set_sensitive(!muteToggleButton->get_active());
 }
 
 void DeviceWidget::onDefaultToggleButton() {
@@ -194,9 +258,14 @@ void DeviceWidget::executeVolumeUpdate() {
 }
 
 void DeviceWidget::setBaseVolume(pa_volume_t v) {
+    baseVolume = v;
+
+    if (allChannelsWidget)
+        allChannelsWidget->setBaseVolume(v);
 
     for (int i = 0; i < channelMap.channels; i++)
-        channelWidgets[i]->setBaseVolume(v);
+        if (channelWidgets[i])
+            channelWidgets[i]->setBaseVolume(v);
 }
 
 void DeviceWidget::prepareMenu() {
@@ -240,6 +309,10 @@ bool DeviceWidget::onContextTriggerEvent(GdkEventButton* event) {
     return false;
 }
 
+void DeviceWidget::onSaveClipLog() {
+    mpMainWindow->saveClipLog();
+}
+
 void DeviceWidget::renamePopup() {
     if (updating)
         return;
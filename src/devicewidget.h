@@ -50,8 +50,10 @@ public:
     pa_cvolume volume;
 
     ChannelWidget *channelWidgets[PA_CHANNELS_MAX];
+    ChannelWidget *allChannelsWidget;
 
     virtual void onMuteToggleButton();
+    virtual void onLockToggleButton();
     virtual void onDefaultToggleButton();
     virtual void setDefault(bool isDefault);
     virtual bool onContextTriggerEvent(GdkEventButton*);
@@ -64,6 +66,7 @@ public:
 
     virtual void executeVolumeUpdate();
     virtual void setBaseVolume(pa_volume_t v);
+    void updateChannelView();
 
     std::vector< std::pair<Glib::ustring,Glib::ustring> > ports;
     Glib::ustring activePort;
@@ -71,14 +74,18 @@ public:
     void prepareMenu();
 
     void renamePopup();
+    void onSaveClipLog();
 
 protected:
     MainWindow *mpMainWindow;
 
     virtual void onPortChange() = 0;
+    virtual void onDrainPopup() = 0;
 
     Gtk::Menu contextMenu;
     Gtk::MenuItem rename;
+    Gtk::MenuItem drain;
+    Gtk::MenuItem saveClipLog;
 
 
     /* Tree model columns */
@@ -103,6 +110,11 @@ protected:
 private:
     Glib::ustring mDeviceType;
 
+    bool canDecibel;
+    pa_volume_t baseVolume;
+
+    ChannelWidget* createChannelWidget(int channel, const char *label, bool last);
+
 };
 
 #endif
@@ -0,0 +1,795 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <map>
+
+#include "pavucontrol.h"
+#include <pulse/ext-stream-restore.h>
+
+#include "headless.h"
+#include "jsonwriter.h"
+
+#include "i18n.h"
+
+/* Output is written out whenever this much has piled up */
+#define HEADLESS_FLUSH_SIZE (64 * 1024)
+
+static pa_mainloop *mainloop = NULL;
+static pa_context *headless_context = NULL;
+static JsonWriter output;
+static int n_outstanding = 0;
+static const char *section = NULL;
+
+static void quit(int ret) {
+    pa_mainloop_quit(mainloop, ret);
+}
+
+static bool flush_output(bool force) {
+    std::string &b = output.buffer();
+
+    if (b.empty() || (!force && b.size() < HEADLESS_FLUSH_SIZE))
+        return true;
+
+    if (fwrite(b.data(), 1, b.size(), stdout) != b.size() || fflush(stdout) != 0) {
+        fprintf(stderr, _("Failed to write output: %s\n"), strerror(errno));
+        return false;
+    }
+
+    b.clear();
+    return true;
+}
+
+/*** Serialization ***/
+static void write_proplist(JsonWriter &json, pa_proplist *p) {
+    void *state = NULL;
+    const char *k;
+
+    json.key("properties");
+    json.beginObject();
+
+    while ((k = pa_proplist_iterate(p, &state))) {
+        const char *v;
+
+        /* Binary properties are left out */
+        if ((v = pa_proplist_gets(p, k)))
+            json.member(k, v);
+    }
+
+    json.endObject();
+}
+
+static void write_volume(JsonWriter &json, const pa_cvolume &v) {
+    json.key("volume");
+    json.beginArray();
+    for (uint8_t i = 0; i < v.channels; i++)
+        json.number((long long) v.values[i]);
+    json.endArray();
+}
+
+static void write_spec(JsonWriter &json, const pa_sample_spec &ss, const pa_channel_map &map) {
+    char st[PA_SAMPLE_SPEC_SNPRINT_MAX], mt[PA_CHANNEL_MAP_SNPRINT_MAX];
+
+    json.member("sample_spec", pa_sample_spec_snprint(st, sizeof(st), &ss));
+    json.member("channel_map", pa_channel_map_snprint(mt, sizeof(mt), &map));
+}
+
+template <typename T> static void write_ports(JsonWriter &json, T * const *ports, uint32_t n_ports, T *active) {
+    json.key("ports");
+    json.beginArray();
+
+    for (uint32_t i = 0; i < n_ports; i++) {
+        json.beginObject();
+        json.member("name", ports[i]->name);
+        json.member("description", ports[i]->description);
+        json.key("priority");
+        json.number((long long) ports[i]->priority);
+        json.endObject();
+    }
+
+    json.endArray();
+    json.member("active_port", active ? active->name : NULL);
+}
+
+static void write_card(JsonWriter &json, const pa_card_info &i) {
+    json.beginObject();
+    json.index("index", i.index);
+    json.member("name", i.name);
+    json.member("driver", i.driver);
+    json.index("owner_module", i.owner_module);
+
+    json.key("profiles");
+    json.beginArray();
+    for (uint32_t j = 0; j < i.n_profiles; j++) {
+        json.beginObject();
+        json.member("name", i.profiles[j].name);
+        json.member("description", i.profiles[j].description);
+        json.key("priority");
+        json.number((long long) i.profiles[j].priority);
+        json.key("n_sinks");
+        json.number((long long) i.profiles[j].n_sinks);
+        json.key("n_sources");
+        json.number((long long) i.profiles[j].n_sources);
+        json.endObject();
+    }
+    json.endArray();
+    json.member("active_profile", i.active_profile ? i.active_profile->name : NULL);
+
+    write_proplist(json, i.proplist);
+    json.endObject();
+}
+
+static void write_sink(JsonWriter &json, const pa_sink_info &i) {
+    json.beginObject();
+    json.index("index", i.index);
+    json.member("name", i.name);
+    json.member("description", i.description);
+    json.member("driver", i.driver);
+    json.index("card", i.card);
+    json.index("owner_module", i.owner_module);
+    json.key("state");
+    json.number((long long) i.state);
+    write_spec(json, i.sample_spec, i.channel_map);
+    json.member("mute", !!i.mute);
+    write_volume(json, i.volume);
+    json.key("base_volume");
+    json.number((long long) i.base_volume);
+    json.member("hardware", !!(i.flags & PA_SINK_HARDWARE));
+    json.index("monitor_source", i.monitor_source);
+    write_ports(json, i.ports, i.n_ports, i.active_port);
+    write_proplist(json, i.proplist);
+    json.endObject();
+}
+
+static void write_source(JsonWriter &json, const pa_source_info &i) {
+    json.beginObject();
+    json.index("index", i.index);
+    json.member("name", i.name);
+    json.member("description", i.description);
+    json.member("driver", i.driver);
+    json.index("card", i.card);
+    json.index("owner_module", i.owner_module);
+    json.key("state");
+    json.number((long long) i.state);
+    write_spec(json, i.sample_spec, i.channel_map);
+    json.member("mute", !!i.mute);
+    write_volume(json, i.volume);
+    json.key("base_volume");
+    json.number((long long) i.base_volume);
+    json.member("hardware", !!(i.flags & PA_SOURCE_HARDWARE));
+    json.index("monitor_of_sink", i.monitor_of_sink);
+    write_ports(json, i.ports, i.n_ports, i.active_port);
+    write_proplist(json, i.proplist);
+    json.endObject();
+}
+
+static void write_sink_input(JsonWriter &json, const pa_sink_input_info &i) {
+    json.beginObject();
+    json.index("index", i.index);
+    json.member("name", i.name);
+    json.member("driver", i.driver);
+    json.index("client", i.client);
+    json.index("sink", i.sink);
+    json.index("owner_module", i.owner_module);
+    write_spec(json, i.sample_spec, i.channel_map);
+    json.member("resample_method", i.resample_method);
+    json.member("corked", !!i.corked);
+    json.member("mute", !!i.mute);
+    write_volume(json, i.volume);
+    json.key("buffer_usec");
+    json.number((long long) i.buffer_usec);
+    json.key("sink_usec");
+    json.number((long long) i.sink_usec);
+    write_proplist(json, i.proplist);
+    json.endObject();
+}
+
+static void write_source_output(JsonWriter &json, const pa_source_output_info &i) {
+    json.beginObject();
+    json.index("index", i.index);
+    json.member("name", i.name);
+    json.member("driver", i.driver);
+    json.index("client", i.client);
+    json.index("source", i.source);
+    json.index("owner_module", i.owner_module);
+    write_spec(json, i.sample_spec, i.channel_map);
+    json.member("resample_method", i.resample_method);
+    json.member("corked", !!i.corked);
+#if HAVE_SOURCE_OUTPUT_VOLUMES
+    json.member("mute", !!i.mute);
+    write_volume(json, i.volume);
+#endif
+    json.key("buffer_usec");
+    json.number((long long) i.buffer_usec);
+    json.key("source_usec");
+    json.number((long long) i.source_usec);
+    write_proplist(json, i.proplist);
+    json.endObject();
+}
+
+static void write_client(JsonWriter &json, const pa_client_info &i) {
+    json.beginObject();
+    json.index("index", i.index);
+    json.member("name", i.name);
+    json.member("driver", i.driver);
+    json.index("owner_module", i.owner_module);
+    write_proplist(json, i.proplist);
+    json.endObject();
+}
+
+static void write_role(JsonWriter &json, const pa_ext_stream_restore_info &i) {
+    char t[PA_CHANNEL_MAP_SNPRINT_MAX];
+
+    json.beginObject();
+    json.member("name", i.name);
+    json.member("device", i.device);
+    json.member("channel_map", pa_channel_map_snprint(t, sizeof(t), &i.channel_map));
+    json.member("mute", !!i.mute);
+    write_volume(json, i.volume);
+    json.endObject();
+}
+
+static void write_server(JsonWriter &json, const pa_server_info &i) {
+    char t[PA_SAMPLE_SPEC_SNPRINT_MAX];
+
+    json.beginObject();
+    json.member("server_name", i.server_name);
+    json.member("server_version", i.server_version);
+    json.member("host_name", i.host_name);
+    json.member("user_name", i.user_name);
+    json.member("sample_spec", pa_sample_spec_snprint(t, sizeof(t), &i.sample_spec));
+    json.member("default_sink", i.default_sink_name);
+    json.member("default_source", i.default_source_name);
+    json.endObject();
+}
+
+/*** --dump ***/
+
+/* Replies come back in the order the queries were sent, so each list is
+ * written out as one array while it arrives */
+static void end_section(void) {
+    if (section)
+        output.endArray();
+
+    section = NULL;
+}
+
+static void begin_section(const char *name) {
+    if (section == name)
+        return;
+
+    end_section();
+
+    section = name;
+    output.key(name);
+    output.beginArray();
+}
+
+static void dump_done(void) {
+    if (--n_outstanding > 0)
+        return;
+
+    end_section();
+    output.endObject();
+    output.endLine();
+
+    quit(flush_output(true) ? 0 : 1);
+}
+
+static void dump_failed(const char *what) {
+    fprintf(stderr, _("%s failed: %s\n"), what, pa_strerror(pa_context_errno(headless_context)));
+    quit(1);
+}
+
+/* All lists share the same shape, only the writer differs */
+#define DUMP_LIST_CB(fn, type, name, writer)                            \
+    static void fn(pa_context *, const type *i, int eol, void *) {      \
+        if (eol < 0) {                                                  \
+            dump_failed(name);                                          \
+            return;                                                     \
+        }                                                               \
+        begin_section(name);                                            \
+        if (eol > 0) {                                                  \
+            dump_done();                                                \
+            return;                                                     \
+        }                                                               \
+        writer(output, *i);                                             \
+        if (!flush_output(false))                                       \
+            quit(1);                                                    \
+    }
+
+DUMP_LIST_CB(dump_card_cb, pa_card_info, "cards", write_card)
+DUMP_LIST_CB(dump_sink_cb, pa_sink_info, "sinks", write_sink)
+DUMP_LIST_CB(dump_source_cb, pa_source_info, "sources", write_source)
+DUMP_LIST_CB(dump_sink_input_cb, pa_sink_input_info, "sink_inputs", write_sink_input)
+DUMP_LIST_CB(dump_source_output_cb, pa_source_output_info, "source_outputs", write_source_output)
+DUMP_LIST_CB(dump_client_cb, pa_client_info, "clients", write_client)
+
+static void dump_role_cb(pa_context *, const pa_ext_stream_restore_info *i, int eol, void *) {
+    begin_section("roles");
+
+    /* Not every server has the stream-restore extension, the list is
+     * just empty then */
+    if (eol != 0) {
+        dump_done();
+        return;
+    }
+
+    write_role(output, *i);
+}
+
+static void dump_server_cb(pa_context *, const pa_server_info *i, void *) {
+    end_section();
+    output.key("server");
+    write_server(output, *i);
+    dump_done();
+}
+
+#define DUMP_QUERY(call, name)                  \
+    do {                                        \
+        pa_operation *o;                        \
+        if (!(o = call)) {                      \
+            dump_failed(name);                  \
+            return;                             \
+        }                                       \
+        pa_operation_unref(o);                  \
+        n_outstanding++;                        \
+    } while (0)
+
+static void dump_state_cb(pa_context *c, void *) {
+    switch (pa_context_get_state(c)) {
+        case PA_CONTEXT_READY:
+            output.beginObject();
+
+            /* The same queries the main window starts with, in the order
+             * the sections are written */
+            DUMP_QUERY(pa_context_get_server_info(c, dump_server_cb, NULL), "pa_context_get_server_info()");
+            DUMP_QUERY(pa_context_get_card_info_list(c, dump_card_cb, NULL), "pa_context_get_card_info_list()");
+            DUMP_QUERY(pa_context_get_sink_info_list(c, dump_sink_cb, NULL), "pa_context_get_sink_info_list()");
+            DUMP_QUERY(pa_context_get_source_info_list(c, dump_source_cb, NULL), "pa_context_get_source_info_list()");
+            DUMP_QUERY(pa_context_get_sink_input_info_list(c, dump_sink_input_cb, NULL), "pa_context_get_sink_input_info_list()");
+            DUMP_QUERY(pa_context_get_source_output_info_list(c, dump_source_output_cb, NULL), "pa_context_get_source_output_info_list()");
+            DUMP_QUERY(pa_context_get_client_info_list(c, dump_client_cb, NULL), "pa_context_get_client_info_list()");
+            DUMP_QUERY(pa_ext_stream_restore_read(c, dump_role_cb, NULL), "pa_ext_stream_restore_read()");
+            break;
+
+        case PA_CONTEXT_FAILED:
+        case PA_CONTEXT_TERMINATED:
+            dump_failed("pa_context_connect()");
+            break;
+
+        default:
+            break;
+    }
+}
+
+static bool headless_connect(pa_context_notify_cb_t cb) {
+    pa_proplist *proplist = pa_proplist_new();
+    pa_proplist_sets(proplist, PA_PROP_APPLICATION_NAME, _("PulseAudio Volume Control"));
+    pa_proplist_sets(proplist, PA_PROP_APPLICATION_ID, "org.PulseAudio.pavucontrol");
+    pa_proplist_sets(proplist, PA_PROP_APPLICATION_ICON_NAME, "audio-card");
+    pa_proplist_sets(proplist, PA_PROP_APPLICATION_VERSION, PACKAGE_VERSION);
+
+    mainloop = pa_mainloop_new();
+    g_assert(mainloop);
+
+    headless_context = pa_context_new_with_proplist(pa_mainloop_get_api(mainloop), NULL, proplist);
+    g_assert(headless_context);
+
+    pa_proplist_free(proplist);
+
+    pa_context_set_state_callback(headless_context, cb, NULL);
+
+    if (pa_context_connect(headless_context, NULL, PA_CONTEXT_NOFLAGS, NULL) < 0) {
+        fprintf(stderr, _("Connection to PulseAudio failed: %s\n"), pa_strerror(pa_context_errno(headless_context)));
+
+        pa_context_unref(headless_context);
+        headless_context = NULL;
+        pa_mainloop_free(mainloop);
+        mainloop = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+static int headless_run(void) {
+    int ret = 1;
+
+    pa_mainloop_run(mainloop, &ret);
+
+    pa_context_set_state_callback(headless_context, NULL, NULL);
+    pa_context_disconnect(headless_context);
+    pa_context_unref(headless_context);
+    headless_context = NULL;
+
+    /* Handlers installed with pa_signal_new() live on the main loop */
+    pa_signal_done();
+    pa_mainloop_free(mainloop);
+    mainloop = NULL;
+
+    return ret;
+}
+
+/*** --watch ***/
+
+enum WatchType {
+    WATCH_SERVER,
+    WATCH_CARD,
+    WATCH_SINK,
+    WATCH_SOURCE,
+    WATCH_SINK_INPUT,
+    WATCH_SOURCE_OUTPUT,
+    WATCH_CLIENT,
+    N_WATCH_TYPES
+};
+
+static const char * const watch_type_names[N_WATCH_TYPES] = {
+    "server", "card", "sink", "source", "sink_input", "source_output", "client"
+};
+
+/* Change notifications for the same object within this time are answered
+ * with one query and one record */
+#define WATCH_COALESCE_USEC (50 * PA_USEC_PER_MSEC)
+
+/* No more queries are sent while this much output is waiting for the
+ * reader, changes keep piling up in watch_pending until it catches up */
+#define WATCH_BUFFER_MAX (1024 * 1024)
+
+typedef std::pair<int, uint32_t> WatchKey;
+
+/* The last seen members of an object, keyed by member name and kept in
+ * their encoded "name":value form */
+typedef std::map<std::string, std::string> WatchFields;
+
+static std::map<WatchKey, WatchFields> watch_objects;
+static std::map<WatchKey, bool> watch_pending;
+static pa_time_event *watch_timer = NULL;
+static pa_io_event *watch_io = NULL;
+static JsonWriter scratch;
+
+static void watch_schedule(void);
+
+static void watch_write_cb(pa_mainloop_api *a, pa_io_event *e, int fd, pa_io_event_flags_t, void *) {
+    std::string &b = output.buffer();
+    ssize_t n;
+
+    if ((n = write(fd, b.data(), b.size())) < 0) {
+        int err = errno;
+
+        if (err == EAGAIN || err == EINTR)
+            return;
+
+        /* The reader went away, which is how a watch normally ends */
+        if (err != EPIPE)
+            fprintf(stderr, _("Failed to write output: %s\n"), strerror(err));
+        quit(err == EPIPE ? 0 : 1);
+        return;
+    }
+
+    b.erase(0, n);
+
+    if (b.empty())
+        a->io_enable(e, PA_IO_EVENT_NULL);
+
+    if (b.size() < WATCH_BUFFER_MAX && !watch_pending.empty())
+        watch_schedule();
+}
+
+static void watch_emit(const char *event, WatchType type, uint32_t index, const std::vector<const std::string*> &members) {
+    output.beginObject();
+    output.member("event", event);
+    output.member("type", watch_type_names[type]);
+    output.index("index", index);
+
+    if (!members.empty()) {
+        output.key("fields");
+        output.beginObject();
+        for (std::vector<const std::string*>::const_iterator i = members.begin(); i != members.end(); ++i)
+            output.raw(**i);
+        output.endObject();
+    }
+
+    output.endObject();
+    output.endLine();
+
+    pa_mainloop_get_api(mainloop)->io_enable(watch_io, PA_IO_EVENT_OUTPUT);
+}
+
+/* Compares the object just serialized into scratch with what we saw last
+ * time and emits the members that differ */
+static void watch_update(WatchType type, uint32_t index) {
+    const std::vector<size_t> &offsets = scratch.memberOffsets();
+    const std::string &b = scratch.buffer();
+    std::vector<const std::string*> changed;
+    WatchFields fields;
+
+    /* Members run up to the separator in front of the next one, the last
+     * one up to the closing brace. Our keys never need escaping. */
+    for (size_t n = 0; n < offsets.size(); n++) {
+        size_t end = (n + 1 < offsets.size() ? offsets[n + 1] : b.size()) - 1;
+        std::string member = b.substr(offsets[n], end - offsets[n]);
+
+        fields[member.substr(1, member.find('"', 1) - 1)].swap(member);
+    }
+
+    std::map<WatchKey, WatchFields>::iterator i = watch_objects.find(WatchKey(type, index));
+    bool is_new = i == watch_objects.end();
+
+    if (is_new)
+        i = watch_objects.insert(std::make_pair(WatchKey(type, index), WatchFields())).first;
+
+    for (WatchFields::iterator f = fields.begin(); f != fields.end(); ++f) {
+        WatchFields::iterator old = i->second.find(f->first);
+
+        if (is_new || old == i->second.end() || old->second != f->second)
+            changed.push_back(&f->second);
+    }
+
+    if (!changed.empty())
+        watch_emit(is_new ? "new" : "change", type, index, changed);
+
+    i->second.swap(fields);
+}
+
+static void watch_remove(WatchType type, uint32_t index) {
+    std::map<WatchKey, WatchFields>::iterator i;
+
+    if ((i = watch_objects.find(WatchKey(type, index))) == watch_objects.end())
+        return;
+
+    watch_objects.erase(i);
+    watch_emit("remove", type, index, std::vector<const std::string*>());
+}
+
+/* Serves both the initial lists and the queries for single objects, for
+ * the latter userdata carries the index in case the object is gone */
+#define WATCH_INFO_CB(fn, type, wtype, writer)                                   \
+    static void fn(pa_context *, const type *i, int eol, void *userdata) {       \
+        if (eol < 0) {                                                           \
+            if (pa_context_errno(headless_context) == PA_ERR_NOENTITY)           \
+                watch_remove(wtype, GPOINTER_TO_UINT(userdata));                 \
+            return;                                                              \
+        }                                                                        \
+        if (eol > 0)                                                             \
+            return;                                                              \
+        scratch.reset();                                                         \
+        writer(scratch, *i);                                                     \
+        watch_update(wtype, i->index);                                           \
+    }
+
+WATCH_INFO_CB(watch_card_cb, pa_card_info, WATCH_CARD, write_card)
+WATCH_INFO_CB(watch_sink_cb, pa_sink_info, WATCH_SINK, write_sink)
+WATCH_INFO_CB(watch_source_cb, pa_source_info, WATCH_SOURCE, write_source)
+WATCH_INFO_CB(watch_sink_input_cb, pa_sink_input_info, WATCH_SINK_INPUT, write_sink_input)
+WATCH_INFO_CB(watch_source_output_cb, pa_source_output_info, WATCH_SOURCE_OUTPUT, write_source_output)
+WATCH_INFO_CB(watch_client_cb, pa_client_info, WATCH_CLIENT, write_client)
+
+static void watch_server_cb(pa_context *, const pa_server_info *i, void *) {
+    scratch.reset();
+    write_server(scratch, *i);
+    watch_update(WATCH_SERVER, PA_INVALID_INDEX);
+}
+
+static void watch_query(WatchType type, uint32_t index) {
+    pa_context *c = headless_context;
+    void *u = GUINT_TO_POINTER(index);
+    pa_operation *o = NULL;
+
+    switch (type) {
+        case WATCH_SERVER:
+            o = pa_context_get_server_info(c, watch_server_cb, NULL);
+            break;
+        case WATCH_CARD:
+            o = pa_context_get_card_info_by_index(c, index, watch_card_cb, u);
+            break;
+        case WATCH_SINK:
+            o = pa_context_get_sink_info_by_index(c, index, watch_sink_cb, u);
+            break;
+        case WATCH_SOURCE:
+            o = pa_context_get_source_info_by_index(c, index, watch_source_cb, u);
+            break;
+        case WATCH_SINK_INPUT:
+            o = pa_context_get_sink_input_info(c, index, watch_sink_input_cb, u);
+            break;
+        case WATCH_SOURCE_OUTPUT:
+            o = pa_context_get_source_output_info(c, index, watch_source_output_cb, u);
+            break;
+        case WATCH_CLIENT:
+            o = pa_context_get_client_info(c, index, watch_client_cb, u);
+            break;
+        default:
+            g_assert_not_reached();
+    }
+
+    if (!o) {
+        fprintf(stderr, _("Failed to query %s %u: %s\n"), watch_type_names[type], index, pa_strerror(pa_context_errno(c)));
+        return;
+    }
+
+    pa_operation_unref(o);
+}
+
+static void watch_timer_cb(pa_mainloop_api *, pa_time_event *, const struct timeval *, void *) {
+    std::map<WatchKey, bool> pending;
+
+    /* The reader is behind, try again once it has caught up */
+    if (output.buffer().size() >= WATCH_BUFFER_MAX)
+        return;
+
+    pending.swap(watch_pending);
+
+    for (std::map<WatchKey, bool>::iterator i = pending.begin(); i != pending.end(); ++i) {
+        if (i->second)
+            watch_remove((WatchType) i->first.first, i->first.second);
+        else
+            watch_query((WatchType) i->first.first, i->first.second);
+    }
+}
+
+static void watch_schedule(void) {
+    pa_mainloop_api *a = pa_mainloop_get_api(mainloop);
+    struct timeval tv;
+
+    pa_timeval_add(pa_gettimeofday(&tv), WATCH_COALESCE_USEC);
+
+    if (!watch_timer)
+        watch_timer = a->time_new(a, &tv, watch_timer_cb, NULL);
+    else
+        a->time_restart(watch_timer, &tv);
+}
+
+static void watch_subscribe_cb(pa_context *, pa_subscription_event_type_t t, uint32_t index, void *) {
+    WatchType type;
+
+    switch (t & PA_SUBSCRIPTION_EVENT_FACILITY_MASK) {
+        case PA_SUBSCRIPTION_EVENT_SERVER:
+            type = WATCH_SERVER;
+            index = PA_INVALID_INDEX;
+            break;
+        case PA_SUBSCRIPTION_EVENT_CARD:
+            type = WATCH_CARD;
+            break;
+        case PA_SUBSCRIPTION_EVENT_SINK:
+            type = WATCH_SINK;
+            break;
+        case PA_SUBSCRIPTION_EVENT_SOURCE:
+            type = WATCH_SOURCE;
+            break;
+        case PA_SUBSCRIPTION_EVENT_SINK_INPUT:
+            type = WATCH_SINK_INPUT;
+            break;
+        case PA_SUBSCRIPTION_EVENT_SOURCE_OUTPUT:
+            type = WATCH_SOURCE_OUTPUT;
+            break;
+        case PA_SUBSCRIPTION_EVENT_CLIENT:
+            type = WATCH_CLIENT;
+            break;
+        default:
+            return;
+    }
+
+    bool &removed = watch_pending[WatchKey(type, index)];
+    removed = (t & PA_SUBSCRIPTION_EVENT_TYPE_MASK) == PA_SUBSCRIPTION_EVENT_REMOVE;
+
+    /* A burst restarts the timer only once, the first event sets the
+     * deadline for everything that follows */
+    if (watch_pending.size() == 1)
+        watch_schedule();
+}
+
+#define WATCH_LIST(call, name)                                                   \
+    do {                                                                         \
+        pa_operation *o;                                                         \
+        if (!(o = call)) {                                                       \
+            dump_failed(name);                                                   \
+            return;                                                              \
+        }                                                                        \
+        pa_operation_unref(o);                                                   \
+    } while (0)
+
+static void watch_state_cb(pa_context *c, void *) {
+    switch (pa_context_get_state(c)) {
+        case PA_CONTEXT_READY:
+            pa_context_set_subscribe_callback(c, watch_subscribe_cb, NULL);
+
+            WATCH_LIST(pa_context_subscribe(c, (pa_subscription_mask_t)
+                                            (PA_SUBSCRIPTION_MASK_SINK|
+                                             PA_SUBSCRIPTION_MASK_SOURCE|
+                                             PA_SUBSCRIPTION_MASK_SINK_INPUT|
+                                             PA_SUBSCRIPTION_MASK_SOURCE_OUTPUT|
+                                             PA_SUBSCRIPTION_MASK_CLIENT|
+                                             PA_SUBSCRIPTION_MASK_SERVER|
+                                             PA_SUBSCRIPTION_MASK_CARD), NULL, NULL), "pa_context_subscribe()");
+
+            /* Everything that is already there is reported as new first */
+            WATCH_LIST(pa_context_get_server_info(c, watch_server_cb, NULL), "pa_context_get_server_info()");
+            WATCH_LIST(pa_context_get_card_info_list(c, watch_card_cb, NULL), "pa_context_get_card_info_list()");
+            WATCH_LIST(pa_context_get_sink_info_list(c, watch_sink_cb, NULL), "pa_context_get_sink_info_list()");
+            WATCH_LIST(pa_context_get_source_info_list(c, watch_source_cb, NULL), "pa_context_get_source_info_list()");
+            WATCH_LIST(pa_context_get_sink_input_info_list(c, watch_sink_input_cb, NULL), "pa_context_get_sink_input_info_list()");
+            WATCH_LIST(pa_context_get_source_output_info_list(c, watch_source_output_cb, NULL), "pa_context_get_source_output_info_list()");
+            WATCH_LIST(pa_context_get_client_info_list(c, watch_client_cb, NULL), "pa_context_get_client_info_list()");
+            break;
+
+        case PA_CONTEXT_FAILED:
+        case PA_CONTEXT_TERMINATED:
+            dump_failed("pa_context_connect()");
+            break;
+
+        default:
+            break;
+    }
+}
+
+/* Interrupting a watch is the usual way to end it, and the main loop has
+ * to return for stdout to get its flags back */
+static void watch_signal_cb(pa_mainloop_api *, pa_signal_event *, int, void *) {
+    quit(0);
+}
+
+int headless_watch(void) {
+    pa_mainloop_api *a;
+    int ret, flags;
+
+    if (!headless_connect(watch_state_cb))
+        return 1;
+
+    a = pa_mainloop_get_api(mainloop);
+
+    if (pa_signal_init(a) == 0) {
+        pa_signal_new(SIGINT, watch_signal_cb, NULL);
+        pa_signal_new(SIGTERM, watch_signal_cb, NULL);
+    }
+
+    /* Output goes out as fast as the reader takes it, never blocking the
+     * main loop. The flag is shared with whoever else has the terminal or
+     * pipe open, so it must not outlive us. */
+    flags = fcntl(STDOUT_FILENO, F_GETFL);
+    fcntl(STDOUT_FILENO, F_SETFL, flags | O_NONBLOCK);
+
+    watch_io = a->io_new(a, STDOUT_FILENO, PA_IO_EVENT_NULL, watch_write_cb, NULL);
+
+    /* headless_run() frees the main loop along with its events */
+    ret = headless_run();
+    watch_io = NULL;
+    watch_timer = NULL;
+
+    fcntl(STDOUT_FILENO, F_SETFL, flags);
+
+    return ret;
+}
+
+int headless_dump(void) {
+    if (!headless_connect(dump_state_cb))
+        return 1;
+
+    return headless_run();
+}
@@ -0,0 +1,35 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+
+#ifndef headless_h
+#define headless_h
+
+/* Command line modes that talk to the server without bringing up GTK */
+
+/* Prints the whole mixer state as one JSON object and returns the exit
+ * status */
+int headless_dump(void);
+
+/* Prints one JSON line for every object that appears, changes or goes
+ * away until the connection or stdout is closed */
+int headless_watch(void);
+
+#endif
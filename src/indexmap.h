@@ -0,0 +1,176 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+#ifndef indexmap_h
+#define indexmap_h
+
+#include <vector>
+#include <utility>
+
+#include "pavucontrol.h"
+
+/* Map from PulseAudio object index to T. Entries live in one array in
+ * insertion order, and an open addressing table of positions into that
+ * array finds them. Maps keyed by server index therefore iterate in
+ * ascending order, maps keyed by anything else (like the GQuarks of
+ * sinksByName) do not.
+ *
+ * erase() only marks the entry as dead, so it is safe while iterating.
+ * insert() may compact the array and invalidates iterators and pointers. */
+template <typename T> class IndexMap {
+public:
+    typedef std::pair<uint32_t, T> Entry;
+
+    class iterator {
+    public:
+        iterator() : mpMap(NULL), mPos(0) {}
+        iterator(IndexMap *map, size_t pos) : mpMap(map), mPos(pos) { skip(); }
+
+        Entry& operator*() const { return mpMap->entries[mPos]; }
+        Entry* operator->() const { return &mpMap->entries[mPos]; }
+
+        iterator& operator++() { mPos++; skip(); return *this; }
+        iterator operator++(int) { iterator r = *this; ++*this; return r; }
+
+        bool operator==(const iterator &o) const { return mPos == o.mPos; }
+        bool operator!=(const iterator &o) const { return mPos != o.mPos; }
+
+    private:
+        IndexMap *mpMap;
+        size_t mPos;
+
+        void skip() {
+            while (mPos < mpMap->entries.size() && mpMap->entries[mPos].first == PA_INVALID_INDEX)
+                mPos++;
+        }
+    };
+
+    IndexMap() : mSize(0) {}
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, entries.size()); }
+
+    size_t size() const { return mSize; }
+    bool empty() const { return mSize == 0; }
+
+    /* Returns NULL if there is no entry for index */
+    T* find(uint32_t index) {
+        long pos = lookup(index);
+
+        return pos < 0 ? NULL : &entries[slots[pos]].second;
+    }
+
+    /* Returns the entry for index, creating a default constructed one
+     * if there is none yet */
+    T& insert(uint32_t index, bool *created = NULL) {
+        long pos = lookup(index);
+
+        if (created)
+            *created = pos < 0;
+
+        if (pos >= 0)
+            return entries[slots[pos]].second;
+
+        if ((entries.size() + 1) * 4 > slots.size() * 3)
+            rehash();
+
+        pos = probe(index);
+        slots[pos] = entries.size();
+        entries.push_back(Entry(index, T()));
+        mSize++;
+
+        return entries.back().second;
+    }
+
+    bool erase(uint32_t index) {
+        long pos = lookup(index);
+
+        if (pos < 0)
+            return false;
+
+        /* The slot keeps pointing at the dead entry so that probe
+         * sequences running through it stay intact */
+        entries[slots[pos]] = Entry(PA_INVALID_INDEX, T());
+        mSize--;
+
+        return true;
+    }
+
+    void clear() {
+        entries.clear();
+        slots.clear();
+        mSize = 0;
+    }
+
+private:
+    std::vector<Entry> entries;
+    std::vector<long> slots;
+    size_t mSize;
+
+    size_t hash(uint32_t index) const {
+        return (index * 2654435761U) & (slots.size() - 1);
+    }
+
+    /* Position in slots holding index, or -1 */
+    long lookup(uint32_t index) const {
+        if (slots.empty() || index == PA_INVALID_INDEX)
+            return -1;
+
+        for (size_t pos = hash(index);; pos = (pos + 1) & (slots.size() - 1)) {
+            if (slots[pos] < 0)
+                return -1;
+
+            if (entries[slots[pos]].first == index)
+                return pos;
+        }
+    }
+
+    /* First free position in slots for index */
+    long probe(uint32_t index) const {
+        size_t pos;
+
+        for (pos = hash(index); slots[pos] >= 0; pos = (pos + 1) & (slots.size() - 1))
+            ;
+
+        return pos;
+    }
+
+    /* Drops dead entries and rebuilds the table with room to grow */
+    void rehash() {
+        std::vector<Entry> live;
+        size_t n = 16;
+
+        live.reserve(mSize + 1);
+        for (size_t i = 0; i < entries.size(); i++)
+            if (entries[i].first != PA_INVALID_INDEX)
+                live.push_back(entries[i]);
+
+        while (n * 3 < (live.size() + 1) * 8)
+            n *= 2;
+
+        entries.swap(live);
+        slots.assign(n, -1);
+
+        for (size_t i = 0; i < entries.size(); i++)
+            slots[probe(entries[i].first)] = i;
+    }
+};
+
+#endif
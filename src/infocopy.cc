@@ -0,0 +1,303 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+
+#include "infocopy.h"
+
+template <typename T> static T** copy_ports(T * const *ports, uint32_t n_ports, T *active, T **active_copy) {
+    T **r;
+
+    *active_copy = NULL;
+
+    if (n_ports == 0)
+        return NULL;
+
+    r = g_new0(T*, n_ports + 1);
+
+    for (uint32_t i = 0; i < n_ports; ++i) {
+        r[i] = g_new0(T, 1);
+        r[i]->name = g_strdup(ports[i]->name);
+        r[i]->description = g_strdup(ports[i]->description);
+        r[i]->priority = ports[i]->priority;
+        r[i]->available = ports[i]->available;
+
+        if (ports[i] == active)
+            *active_copy = r[i];
+    }
+
+    return r;
+}
+
+template <typename T> static void free_ports(T **ports, uint32_t n_ports) {
+    if (!ports)
+        return;
+
+    for (uint32_t i = 0; i < n_ports; ++i) {
+        g_free((char*) ports[i]->name);
+        g_free((char*) ports[i]->description);
+        g_free(ports[i]);
+    }
+
+    g_free(ports);
+}
+
+static pa_format_info** copy_formats(pa_format_info * const *formats, uint8_t n_formats) {
+    pa_format_info **r;
+
+    if (n_formats == 0)
+        return NULL;
+
+    r = g_new0(pa_format_info*, n_formats);
+
+    for (uint8_t i = 0; i < n_formats; ++i)
+        r[i] = pa_format_info_copy(formats[i]);
+
+    return r;
+}
+
+static void free_formats(pa_format_info **formats, uint8_t n_formats) {
+    if (!formats)
+        return;
+
+    for (uint8_t i = 0; i < n_formats; ++i)
+        pa_format_info_free(formats[i]);
+
+    g_free(formats);
+}
+
+pa_sink_info* sink_info_copy(const pa_sink_info *i) {
+    pa_sink_info *r = g_new0(pa_sink_info, 1);
+
+    r->name = g_strdup(i->name);
+    r->index = i->index;
+    r->description = g_strdup(i->description);
+    r->sample_spec = i->sample_spec;
+    r->channel_map = i->channel_map;
+    r->owner_module = i->owner_module;
+    r->volume = i->volume;
+    r->mute = i->mute;
+    r->monitor_source = i->monitor_source;
+    r->monitor_source_name = g_strdup(i->monitor_source_name);
+    r->driver = g_strdup(i->driver);
+    r->flags = i->flags;
+    r->proplist = pa_proplist_copy(i->proplist);
+    r->base_volume = i->base_volume;
+    r->state = i->state;
+    r->n_volume_steps = i->n_volume_steps;
+    r->card = i->card;
+    r->n_ports = i->n_ports;
+    r->ports = copy_ports(i->ports, i->n_ports, i->active_port, &r->active_port);
+    r->n_formats = i->n_formats;
+    r->formats = copy_formats(i->formats, i->n_formats);
+
+    return r;
+}
+
+void sink_info_free(pa_sink_info *i) {
+    g_free((char*) i->name);
+    g_free((char*) i->description);
+    g_free((char*) i->monitor_source_name);
+    g_free((char*) i->driver);
+    pa_proplist_free(i->proplist);
+    free_ports(i->ports, i->n_ports);
+    free_formats(i->formats, i->n_formats);
+    g_free(i);
+}
+
+pa_source_info* source_info_copy(const pa_source_info *i) {
+    pa_source_info *r = g_new0(pa_source_info, 1);
+
+    r->name = g_strdup(i->name);
+    r->index = i->index;
+    r->description = g_strdup(i->description);
+    r->sample_spec = i->sample_spec;
+    r->channel_map = i->channel_map;
+    r->owner_module = i->owner_module;
+    r->volume = i->volume;
+    r->mute = i->mute;
+    r->monitor_of_sink = i->monitor_of_sink;
+    r->monitor_of_sink_name = g_strdup(i->monitor_of_sink_name);
+    r->driver = g_strdup(i->driver);
+    r->flags = i->flags;
+    r->proplist = pa_proplist_copy(i->proplist);
+    r->base_volume = i->base_volume;
+    r->state = i->state;
+    r->n_volume_steps = i->n_volume_steps;
+    r->card = i->card;
+    r->n_ports = i->n_ports;
+    r->ports = copy_ports(i->ports, i->n_ports, i->active_port, &r->active_port);
+    r->n_formats = i->n_formats;
+    r->formats = copy_formats(i->formats, i->n_formats);
+
+    return r;
+}
+
+void source_info_free(pa_source_info *i) {
+    g_free((char*) i->name);
+    g_free((char*) i->description);
+    g_free((char*) i->monitor_of_sink_name);
+    g_free((char*) i->driver);
+    pa_proplist_free(i->proplist);
+    free_ports(i->ports, i->n_ports);
+    free_formats(i->formats, i->n_formats);
+    g_free(i);
+}
+
+pa_sink_input_info* sink_input_info_copy(const pa_sink_input_info *i) {
+    pa_sink_input_info *r = g_new0(pa_sink_input_info, 1);
+
+    r->index = i->index;
+    r->name = g_strdup(i->name);
+    r->owner_module = i->owner_module;
+    r->client = i->client;
+    r->sink = i->sink;
+    r->sample_spec = i->sample_spec;
+    r->channel_map = i->channel_map;
+    r->volume = i->volume;
+    r->buffer_usec = i->buffer_usec;
+    r->sink_usec = i->sink_usec;
+    r->resample_method = g_strdup(i->resample_method);
+    r->driver = g_strdup(i->driver);
+    r->mute = i->mute;
+    r->proplist = pa_proplist_copy(i->proplist);
+    r->corked = i->corked;
+    r->has_volume = i->has_volume;
+    r->volume_writable = i->volume_writable;
+    r->format = i->format ? pa_format_info_copy(i->format) : NULL;
+
+    return r;
+}
+
+void sink_input_info_free(pa_sink_input_info *i) {
+    g_free((char*) i->name);
+    g_free((char*) i->resample_method);
+    g_free((char*) i->driver);
+    pa_proplist_free(i->proplist);
+    if (i->format)
+        pa_format_info_free(i->format);
+    g_free(i);
+}
+
+pa_source_output_info* source_output_info_copy(const pa_source_output_info *i) {
+    pa_source_output_info *r = g_new0(pa_source_output_info, 1);
+
+    r->index = i->index;
+    r->name = g_strdup(i->name);
+    r->owner_module = i->owner_module;
+    r->client = i->client;
+    r->source = i->source;
+    r->sample_spec = i->sample_spec;
+    r->channel_map = i->channel_map;
+    r->buffer_usec = i->buffer_usec;
+    r->source_usec = i->source_usec;
+    r->resample_method = g_strdup(i->resample_method);
+    r->driver = g_strdup(i->driver);
+    r->proplist = pa_proplist_copy(i->proplist);
+    r->corked = i->corked;
+#if HAVE_SOURCE_OUTPUT_VOLUMES
+    r->volume = i->volume;
+    r->mute = i->mute;
+    r->has_volume = i->has_volume;
+    r->volume_writable = i->volume_writable;
+#endif
+    r->format = i->format ? pa_format_info_copy(i->format) : NULL;
+
+    return r;
+}
+
+void source_output_info_free(pa_source_output_info *i) {
+    g_free((char*) i->name);
+    g_free((char*) i->resample_method);
+    g_free((char*) i->driver);
+    pa_proplist_free(i->proplist);
+    if (i->format)
+        pa_format_info_free(i->format);
+    g_free(i);
+}
+
+pa_card_info* card_info_copy(const pa_card_info *i) {
+    pa_card_info *r = g_new0(pa_card_info, 1);
+
+    r->index = i->index;
+    r->name = g_strdup(i->name);
+    r->owner_module = i->owner_module;
+    r->driver = g_strdup(i->driver);
+    r->n_profiles = i->n_profiles;
+    r->proplist = pa_proplist_copy(i->proplist);
+
+    if (i->n_profiles > 0) {
+        r->profiles = g_new0(pa_card_profile_info, i->n_profiles);
+
+        for (uint32_t j = 0; j < i->n_profiles; ++j) {
+            r->profiles[j] = i->profiles[j];
+            r->profiles[j].name = g_strdup(i->profiles[j].name);
+            r->profiles[j].description = g_strdup(i->profiles[j].description);
+
+            if (i->active_profile == &i->profiles[j])
+                r->active_profile = &r->profiles[j];
+        }
+    }
+
+    /* Card ports are kept for their latency offsets, without the
+     * profiles they belong to */
+    r->n_ports = i->n_ports;
+
+    if (i->n_ports > 0) {
+        r->ports = g_new0(pa_card_port_info*, i->n_ports + 1);
+
+        for (uint32_t j = 0; j < i->n_ports; ++j) {
+            r->ports[j] = g_new0(pa_card_port_info, 1);
+            r->ports[j]->name = g_strdup(i->ports[j]->name);
+            r->ports[j]->description = g_strdup(i->ports[j]->description);
+            r->ports[j]->priority = i->ports[j]->priority;
+            r->ports[j]->available = i->ports[j]->available;
+            r->ports[j]->direction = i->ports[j]->direction;
+            r->ports[j]->latency_offset = i->ports[j]->latency_offset;
+        }
+    }
+
+    return r;
+}
+
+void card_info_free(pa_card_info *i) {
+    for (uint32_t j = 0; j < i->n_profiles; ++j) {
+        g_free((char*) i->profiles[j].name);
+        g_free((char*) i->profiles[j].description);
+    }
+
+    g_free(i->profiles);
+
+    for (uint32_t j = 0; j < i->n_ports; ++j) {
+        g_free((char*) i->ports[j]->name);
+        g_free((char*) i->ports[j]->description);
+        g_free(i->ports[j]);
+    }
+
+    g_free(i->ports);
+    g_free((char*) i->name);
+    g_free((char*) i->driver);
+    pa_proplist_free(i->proplist);
+    g_free(i);
+}
@@ -0,0 +1,45 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+#ifndef infocopy_h
+#define infocopy_h
+
+#include "pavucontrol.h"
+
+/* Deep copies of the introspection structs, which libpulse only lends us
+ * for the duration of a callback. Only the fields pavucontrol looks at are
+ * copied, everything else is zeroed. */
+
+pa_sink_info* sink_info_copy(const pa_sink_info *i);
+void sink_info_free(pa_sink_info *i);
+
+pa_source_info* source_info_copy(const pa_source_info *i);
+void source_info_free(pa_source_info *i);
+
+pa_sink_input_info* sink_input_info_copy(const pa_sink_input_info *i);
+void sink_input_info_free(pa_sink_input_info *i);
+
+pa_source_output_info* source_output_info_copy(const pa_source_output_info *i);
+void source_output_info_free(pa_source_output_info *i);
+
+pa_card_info* card_info_copy(const pa_card_info *i);
+void card_info_free(pa_card_info *i);
+
+#endif
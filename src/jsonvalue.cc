@@ -0,0 +1,406 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+
+#include <math.h>
+#include <string.h>
+
+#include "jsonvalue.h"
+#include "jsonwriter.h"
+
+/* Deeper documents are refused rather than recursed into */
+#define JSON_MAX_DEPTH 64
+
+class JsonParser {
+public:
+    JsonParser(const std::string &text) : p(text.c_str()), end(text.c_str() + text.size()), depth(0) {}
+
+    JsonValue* document(std::string *error);
+
+private:
+    const char *p, *end;
+    unsigned depth;
+    std::string mError;
+
+    void skipSpace();
+    bool fail(const char *what);
+    JsonValue* value();
+    bool string(std::string &s);
+    bool hex4(unsigned &u);
+    JsonValue* number();
+    JsonValue* literal(const char *word, JsonValue *v);
+};
+
+void JsonParser::skipSpace() {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+        p++;
+}
+
+bool JsonParser::fail(const char *what) {
+    if (mError.empty())
+        mError = what;
+    return false;
+}
+
+JsonValue* JsonParser::document(std::string *error) {
+    JsonValue *v;
+
+    if ((v = value())) {
+        skipSpace();
+
+        if (p != end) {
+            delete v;
+            v = NULL;
+            fail("trailing data");
+        }
+    }
+
+    if (!v && error)
+        *error = mError;
+
+    return v;
+}
+
+JsonValue* JsonParser::value() {
+    JsonValue *v;
+
+    skipSpace();
+
+    if (p >= end) {
+        fail("unexpected end of input");
+        return NULL;
+    }
+
+    switch (*p) {
+        case '{':
+            if (++depth > JSON_MAX_DEPTH) {
+                fail("nested too deeply");
+                return NULL;
+            }
+
+            v = new JsonValue(JsonValue::JSON_OBJECT);
+            p++;
+            skipSpace();
+
+            if (p < end && *p == '}') {
+                p++;
+                depth--;
+                return v;
+            }
+
+            for (;;) {
+                std::string key;
+                JsonValue *m;
+
+                skipSpace();
+                if (!string(key)) {
+                    delete v;
+                    return NULL;
+                }
+
+                skipSpace();
+                if (p >= end || *p != ':') {
+                    fail("expected ':'");
+                    delete v;
+                    return NULL;
+                }
+                p++;
+
+                if (!(m = value())) {
+                    delete v;
+                    return NULL;
+                }
+
+                /* The last of duplicate keys wins */
+                delete v->mMembers[key];
+                v->mMembers[key] = m;
+
+                skipSpace();
+                if (p < end && *p == ',') {
+                    p++;
+                    continue;
+                }
+                if (p < end && *p == '}') {
+                    p++;
+                    break;
+                }
+
+                fail("expected ',' or '}'");
+                delete v;
+                return NULL;
+            }
+
+            depth--;
+            return v;
+
+        case '[':
+            if (++depth > JSON_MAX_DEPTH) {
+                fail("nested too deeply");
+                return NULL;
+            }
+
+            v = new JsonValue(JsonValue::JSON_ARRAY);
+            p++;
+            skipSpace();
+
+            if (p < end && *p == ']') {
+                p++;
+                depth--;
+                return v;
+            }
+
+            for (;;) {
+                JsonValue *item;
+
+                if (!(item = value())) {
+                    delete v;
+                    return NULL;
+                }
+
+                v->mItems.push_back(item);
+
+                skipSpace();
+                if (p < end && *p == ',') {
+                    p++;
+                    continue;
+                }
+                if (p < end && *p == ']') {
+                    p++;
+                    break;
+                }
+
+                fail("expected ',' or ']'");
+                delete v;
+                return NULL;
+            }
+
+            depth--;
+            return v;
+
+        case '"':
+            v = new JsonValue(JsonValue::JSON_STRING);
+            if (!string(v->mString)) {
+                delete v;
+                return NULL;
+            }
+            return v;
+
+        case 't':
+            v = new JsonValue(JsonValue::JSON_BOOLEAN);
+            v->mBoolean = true;
+            return literal("true", v);
+
+        case 'f':
+            return literal("false", new JsonValue(JsonValue::JSON_BOOLEAN));
+
+        case 'n':
+            return literal("null", new JsonValue(JsonValue::JSON_NULL));
+
+        default:
+            return number();
+    }
+}
+
+JsonValue* JsonParser::literal(const char *word, JsonValue *v) {
+    size_t l = strlen(word);
+
+    if ((size_t) (end - p) < l || strncmp(p, word, l) != 0) {
+        fail("invalid literal");
+        delete v;
+        return NULL;
+    }
+
+    p += l;
+    return v;
+}
+
+JsonValue* JsonParser::number() {
+    const char *start = p;
+    std::string s;
+    char *e;
+    double d;
+
+    while (p < end && (g_ascii_isdigit(*p) || *p == '-' || *p == '+' || *p == '.' || *p == 'e' || *p == 'E'))
+        p++;
+
+    if (p == start) {
+        fail("unexpected character");
+        return NULL;
+    }
+
+    /* The text is not NUL terminated at the end of the number */
+    s.assign(start, p - start);
+    d = g_ascii_strtod(s.c_str(), &e);
+
+    if (*e || isinf(d) || isnan(d)) {
+        fail("invalid number");
+        return NULL;
+    }
+
+    JsonValue *v = new JsonValue(JsonValue::JSON_NUMBER);
+    v->mNumber = d;
+    return v;
+}
+
+bool JsonParser::hex4(unsigned &u) {
+    u = 0;
+
+    for (int i = 0; i < 4; i++, p++) {
+        if (p >= end || !g_ascii_isxdigit(*p))
+            return fail("invalid \\u escape");
+        u = u * 16 + g_ascii_xdigit_value(*p);
+    }
+
+    return true;
+}
+
+bool JsonParser::string(std::string &s) {
+    if (p >= end || *p != '"')
+        return fail("expected string");
+
+    for (p++; p < end && *p != '"'; ) {
+        if ((unsigned char) *p < 0x20)
+            return fail("control character in string");
+
+        if (*p != '\\') {
+            s += *p++;
+            continue;
+        }
+
+        if (++p >= end)
+            break;
+
+        switch (*p++) {
+            case '"': s += '"'; break;
+            case '\\': s += '\\'; break;
+            case '/': s += '/'; break;
+            case 'b': s += '\b'; break;
+            case 'f': s += '\f'; break;
+            case 'n': s += '\n'; break;
+            case 'r': s += '\r'; break;
+            case 't': s += '\t'; break;
+            case 'u': {
+                unsigned u, low;
+                char utf8[6];
+
+                if (!hex4(u))
+                    return false;
+
+                /* Characters outside the BMP come as surrogate pairs */
+                if (u >= 0xd800 && u < 0xdc00) {
+                    if (end - p < 2 || p[0] != '\\' || p[1] != 'u')
+                        return fail("lone surrogate");
+                    p += 2;
+                    if (!hex4(low))
+                        return false;
+                    if (low < 0xdc00 || low >= 0xe000)
+                        return fail("lone surrogate");
+                    u = 0x10000 + ((u - 0xd800) << 10) + (low - 0xdc00);
+                } else if (u >= 0xdc00 && u < 0xe000)
+                    return fail("lone surrogate");
+
+                s.append(utf8, g_unichar_to_utf8(u, utf8));
+                break;
+            }
+            default:
+                return fail("invalid escape");
+        }
+    }
+
+    if (p >= end)
+        return fail("unterminated string");
+
+    p++;
+
+    if (!g_utf8_validate(s.data(), s.size(), NULL))
+        return fail("invalid UTF-8");
+
+    return true;
+}
+
+/*** JsonValue ***/
+JsonValue::JsonValue(Type type) :
+    mType(type),
+    mBoolean(false),
+    mNumber(0) {
+}
+
+JsonValue::~JsonValue() {
+    for (std::vector<JsonValue*>::iterator i = mItems.begin(); i != mItems.end(); ++i)
+        delete *i;
+
+    for (std::map<std::string, JsonValue*>::iterator i = mMembers.begin(); i != mMembers.end(); ++i)
+        delete i->second;
+}
+
+JsonValue* JsonValue::parse(const std::string &text, std::string *error) {
+    JsonParser parser(text);
+
+    return parser.document(error);
+}
+
+const JsonValue* JsonValue::get(const char *key) const {
+    std::map<std::string, JsonValue*>::const_iterator i = mMembers.find(key);
+
+    return i == mMembers.end() ? NULL : i->second;
+}
+
+void JsonValue::write(JsonWriter &w) const {
+    switch (mType) {
+        case JSON_NULL:
+            w.null();
+            break;
+
+        case JSON_BOOLEAN:
+            w.boolean(mBoolean);
+            break;
+
+        case JSON_NUMBER:
+            if (mNumber == floor(mNumber) && fabs(mNumber) < 1e15)
+                w.number((long long) mNumber);
+            else
+                w.number(mNumber);
+            break;
+
+        case JSON_STRING:
+            w.string(mString.c_str());
+            break;
+
+        case JSON_ARRAY:
+            w.beginArray();
+            for (std::vector<JsonValue*>::const_iterator i = mItems.begin(); i != mItems.end(); ++i)
+                (*i)->write(w);
+            w.endArray();
+            break;
+
+        case JSON_OBJECT:
+            w.beginObject();
+            for (std::map<std::string, JsonValue*>::const_iterator i = mMembers.begin(); i != mMembers.end(); ++i) {
+                w.key(i->first.c_str());
+                i->second->write(w);
+            }
+            w.endObject();
+            break;
+    }
+}
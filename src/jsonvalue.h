@@ -0,0 +1,89 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+
+#ifndef jsonvalue_h
+#define jsonvalue_h
+
+#include <string>
+#include <vector>
+#include <map>
+
+#include "pavucontrol.h"
+
+class JsonWriter;
+
+/* A parsed JSON document. Values own their children and are handed
+ * around by pointer, like the widgets. */
+class JsonValue {
+public:
+    enum Type {
+        JSON_NULL,
+        JSON_BOOLEAN,
+        JSON_NUMBER,
+        JSON_STRING,
+        JSON_ARRAY,
+        JSON_OBJECT
+    };
+
+    JsonValue(Type type = JSON_NULL);
+    ~JsonValue();
+
+    /* Returns NULL and sets error if text is not a single JSON value */
+    static JsonValue* parse(const std::string &text, std::string *error = NULL);
+
+    Type type() const { return mType; }
+    bool isNull() const { return mType == JSON_NULL; }
+    bool isBoolean() const { return mType == JSON_BOOLEAN; }
+    bool isNumber() const { return mType == JSON_NUMBER; }
+    bool isString() const { return mType == JSON_STRING; }
+    bool isArray() const { return mType == JSON_ARRAY; }
+    bool isObject() const { return mType == JSON_OBJECT; }
+
+    bool asBoolean() const { return mBoolean; }
+    double asNumber() const { return mNumber; }
+    const std::string& asString() const { return mString; }
+
+    /* Array elements */
+    size_t size() const { return mItems.size(); }
+    const JsonValue* at(size_t i) const { return mItems[i]; }
+
+    /* Object members, NULL if there is no such member */
+    const JsonValue* get(const char *key) const;
+    const std::map<std::string, JsonValue*>& members() const { return mMembers; }
+
+    /* Encodes the value again */
+    void write(JsonWriter &w) const;
+
+private:
+    Type mType;
+    bool mBoolean;
+    double mNumber;
+    std::string mString;
+    std::vector<JsonValue*> mItems;
+    std::map<std::string, JsonValue*> mMembers;
+
+    JsonValue(const JsonValue&);
+    JsonValue& operator=(const JsonValue&);
+
+    friend class JsonParser;
+};
+
+#endif
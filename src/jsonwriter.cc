@@ -0,0 +1,192 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+
+#include <stdio.h>
+#include <math.h>
+
+#include "jsonwriter.h"
+
+/*** JsonWriter ***/
+JsonWriter::JsonWriter() :
+    mAfterKey(false) {
+}
+
+void JsonWriter::separate() {
+    if (mAfterKey) {
+        mAfterKey = false;
+        return;
+    }
+
+    if (mFirst.empty())
+        return;
+
+    if (!mFirst.back())
+        mBuffer += ',';
+    mFirst.back() = false;
+}
+
+void JsonWriter::beginObject() {
+    separate();
+
+    if (mFirst.empty())
+        mMembers.clear();
+    mBuffer += '{';
+    mFirst.push_back(true);
+}
+
+void JsonWriter::endObject() {
+    g_assert(!mFirst.empty());
+    mFirst.pop_back();
+    mBuffer += '}';
+}
+
+void JsonWriter::beginArray() {
+    separate();
+    mBuffer += '[';
+    mFirst.push_back(true);
+}
+
+void JsonWriter::endArray() {
+    g_assert(!mFirst.empty());
+    mFirst.pop_back();
+    mBuffer += ']';
+}
+
+void JsonWriter::key(const char *k) {
+    separate();
+
+    if (mFirst.size() == 1)
+        mMembers.push_back(mBuffer.size());
+
+    quote(k);
+    mBuffer += ':';
+    mAfterKey = true;
+}
+
+void JsonWriter::string(const char *s) {
+    if (!s) {
+        null();
+        return;
+    }
+
+    separate();
+    quote(s);
+}
+
+void JsonWriter::quote(const char *s) {
+    mBuffer += '"';
+
+    for (; *s; s++) {
+        switch (*s) {
+            case '"':
+                mBuffer += "\\\"";
+                break;
+            case '\\':
+                mBuffer += "\\\\";
+                break;
+            case '\n':
+                mBuffer += "\\n";
+                break;
+            case '\r':
+                mBuffer += "\\r";
+                break;
+            case '\t':
+                mBuffer += "\\t";
+                break;
+            default:
+                if ((unsigned char) *s < 0x20) {
+                    char t[8];
+                    snprintf(t, sizeof(t), "\\u%04x", (unsigned char) *s);
+                    mBuffer += t;
+                } else
+                    mBuffer += *s;
+        }
+    }
+
+    mBuffer += '"';
+}
+
+void JsonWriter::number(long long n) {
+    char t[32];
+
+    separate();
+    snprintf(t, sizeof(t), "%lld", n);
+    mBuffer += t;
+}
+
+void JsonWriter::number(double d) {
+    char t[G_ASCII_DTOSTR_BUF_SIZE];
+
+    /* JSON has no infinities, -inf dB volumes become null */
+    if (isnan(d) || isinf(d)) {
+        null();
+        return;
+    }
+
+    /* Not snprintf(), the decimal separator must not follow the locale.
+     * The shortest form that reads back as the same double, so ids echoed
+     * back to a client compare equal. */
+    separate();
+    g_ascii_formatd(t, sizeof(t), "%.15g", d);
+    if (g_ascii_strtod(t, NULL) != d)
+        g_ascii_formatd(t, sizeof(t), "%.17g", d);
+    mBuffer += t;
+}
+
+void JsonWriter::boolean(bool b) {
+    separate();
+    mBuffer += b ? "true" : "false";
+}
+
+void JsonWriter::null() {
+    separate();
+    mBuffer += "null";
+}
+
+void JsonWriter::index(const char *k, uint32_t idx) {
+    key(k);
+
+    if (idx == PA_INVALID_INDEX)
+        null();
+    else
+        number((long long) idx);
+}
+
+void JsonWriter::raw(const std::string &s) {
+    separate();
+    mBuffer += s;
+}
+
+void JsonWriter::reset() {
+    mBuffer.clear();
+    mFirst.clear();
+    mMembers.clear();
+    mAfterKey = false;
+}
+
+void JsonWriter::endLine() {
+    g_assert(mFirst.empty());
+    mBuffer += '\n';
+}
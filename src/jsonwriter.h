@@ -0,0 +1,79 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+
+#ifndef jsonwriter_h
+#define jsonwriter_h
+
+#include <string>
+#include <vector>
+
+#include "pavucontrol.h"
+
+/* Appends JSON to a buffer as it is produced, the caller decides when
+ * the buffer is written out. Separators are inserted automatically, keys
+ * must be given inside objects and are not checked. */
+class JsonWriter {
+public:
+    JsonWriter();
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+
+    void key(const char *k);
+
+    void string(const char *s);
+    void number(long long n);
+    void number(double d);
+    void boolean(bool b);
+    void null();
+
+    /* Object members, PA_INVALID_INDEX is written as null */
+    void member(const char *k, const char *s) { key(k); string(s); }
+    void member(const char *k, bool b) { key(k); boolean(b); }
+    void index(const char *k, uint32_t idx);
+
+    /* Already encoded JSON, a value or a whole "key":value member */
+    void raw(const std::string &s);
+
+    /* Ends a top level value with a newline */
+    void endLine();
+
+    std::string& buffer() { return mBuffer; }
+    bool complete() const { return mFirst.empty(); }
+    void reset();
+
+    /* Where each member of the outermost object starts in the buffer, for
+     * picking a serialized object apart again */
+    const std::vector<size_t>& memberOffsets() const { return mMembers; }
+
+private:
+    std::string mBuffer;
+    std::vector<bool> mFirst;
+    std::vector<size_t> mMembers;
+    bool mAfterKey;
+
+    void separate();
+    void quote(const char *s);
+};
+
+#endif
@@ -26,12 +26,15 @@
 
 #include "mainwindow.h"
 
+#include "infocopy.h"
 #include "cardwidget.h"
 #include "sinkwidget.h"
 #include "sourcewidget.h"
 #include "sinkinputwidget.h"
 #include "sourceoutputwidget.h"
 #include "rolewidget.h"
+#include "virtuallist.h"
+#include "devicedrain.h"
 
 #include "i18n.h"
 
@@ -73,10 +76,28 @@ MainWindow::MainWindow(BaseObjectType* cobject, const Glib::RefPtr<Gtk::Builder>
     showSourceOutputType(SOURCE_OUTPUT_CLIENT),
     showSourceType(SOURCE_NO_MONITOR),
     eventRoleWidget(NULL),
+    defaultSinkName(0),
+    defaultSourceName(0),
+    defaultSinkIndex(PA_INVALID_INDEX),
+    defaultSourceIndex(PA_INVALID_INDEX),
+    monitorStreams(this),
+    streamRestore(this),
+    meterScheduler(this),
+    controlSocket(this),
+    snapshot(this),
+    playbackSelection(this, false),
+    recordingSelection(this, true),
+    fader(this),
+    history(this),
+    playbackResampling(this, false),
+    recordingResampling(this, true),
     canRenameDevices(false),
     m_connected(false),
     m_config_filename(NULL) {
 
+    for (int i = 0; i < N_PAGES; i++)
+        pageBuilt[i] = false;
+
     x->get_widget("cardsVBox", cardsVBox);
     x->get_widget("streamsVBox", streamsVBox);
     x->get_widget("recsVBox", recsVBox);
@@ -93,6 +114,52 @@ MainWindow::MainWindow(BaseObjectType* cobject, const Glib::RefPtr<Gtk::Builder>
     x->get_widget("sinkTypeComboBox", sinkTypeComboBox);
     x->get_widget("sourceTypeComboBox", sourceTypeComboBox);
     x->get_widget("notebook", notebook);
+    x->get_widget("scrolledwindow5", streamsScrolledWindow);
+    x->get_widget("scrolledwindow2", recsScrolledWindow);
+
+    playbackList = Gtk::manage(new VirtualList(streamsScrolledWindow, sigc::mem_fun(*this, &MainWindow::bindPlaybackRows)));
+    streamsVBox->pack_start(*playbackList, false, false, 0);
+    playbackList->show();
+
+    recordingList = Gtk::manage(new VirtualList(recsScrolledWindow, sigc::mem_fun(*this, &MainWindow::bindRecordingRows)));
+    recsVBox->pack_start(*recordingList, false, false, 0);
+    recordingList->show();
+
+    /* The bulk action bars go between the stream list and the filter */
+    Gtk::Box *page = dynamic_cast<Gtk::Box*>(streamsScrolledWindow->get_parent());
+    page->pack_start(playbackSelection, false, false, 0);
+    page->reorder_child(playbackSelection, 1);
+    page = dynamic_cast<Gtk::Box*>(recsScrolledWindow->get_parent());
+    page->pack_start(recordingSelection, false, false, 0);
+    page->reorder_child(recordingSelection, 1);
+
+    /* Followed by the resampling summaries, hidden while no stream is
+     * resampled */
+    page = dynamic_cast<Gtk::Box*>(streamsScrolledWindow->get_parent());
+    page->pack_start(playbackResampling, false, false, 0);
+    page->reorder_child(playbackResampling, 2);
+    page = dynamic_cast<Gtk::Box*>(recsScrolledWindow->get_parent());
+    page->pack_start(recordingResampling, false, false, 0);
+    page->reorder_child(recordingResampling, 2);
+
+    /* The filter entries go in front of the type selectors, the
+     * configuration page has none and gets a bar of its own */
+    addFilterEntry(PAGE_PLAYBACK, dynamic_cast<Gtk::Box*>(sinkInputTypeComboBox->get_parent()));
+    addFilterEntry(PAGE_RECORDING, dynamic_cast<Gtk::Box*>(sourceOutputTypeComboBox->get_parent()));
+    addFilterEntry(PAGE_OUTPUT_DEVICES, dynamic_cast<Gtk::Box*>(sinkTypeComboBox->get_parent()));
+    addFilterEntry(PAGE_INPUT_DEVICES, dynamic_cast<Gtk::Box*>(sourceTypeComboBox->get_parent()));
+
+    Gtk::ScrolledWindow *cardsScrolledWindow;
+    Gtk::Alignment *cardsFilterAlignment = Gtk::manage(new Gtk::Alignment(0.0, 0.5, 1.0, 1.0));
+    Gtk::HBox *cardsFilterBox = Gtk::manage(new Gtk::HBox(false, 6));
+
+    x->get_widget("scrolledwindow1", cardsScrolledWindow);
+    cardsFilterAlignment->set_padding(0, 12, 12, 12);
+    cardsFilterAlignment->add(*cardsFilterBox);
+    page = dynamic_cast<Gtk::Box*>(cardsScrolledWindow->get_parent());
+    page->pack_start(*cardsFilterAlignment, false, false, 0);
+    addFilterEntry(PAGE_CONFIGURATION, cardsFilterBox);
+    cardsFilterAlignment->show_all();
 
     cardsVBox->set_reallocate_redraws(true);
     sourcesVBox->set_reallocate_redraws(true);
@@ -109,6 +176,7 @@ MainWindow::MainWindow(BaseObjectType* cobject, const Glib::RefPtr<Gtk::Builder>
     sourceOutputTypeComboBox->signal_changed().connect(sigc::mem_fun(*this, &MainWindow::onSourceOutputTypeComboBoxChanged));
     sinkTypeComboBox->signal_changed().connect(sigc::mem_fun(*this, &MainWindow::onSinkTypeComboBoxChanged));
     sourceTypeComboBox->signal_changed().connect(sigc::mem_fun(*this, &MainWindow::onSourceTypeComboBoxChanged));
+    notebook->property_page().signal_changed().connect(sigc::mem_fun(*this, &MainWindow::onNotebookPageChanged));
 
     GKeyFile* config = g_key_file_new();
     g_assert(config);
@@ -125,6 +193,25 @@ MainWindow::MainWindow(BaseObjectType* cobject, const Glib::RefPtr<Gtk::Builder>
         get_default_size(default_width, default_height);
         if (width >= default_width && height >= default_height)
             resize(width, height);
+
+        int budget = g_key_file_get_integer(config, "meters", "budget", &err);
+        if (!err && budget >= 0)
+            meterScheduler.setBudget(budget);
+        g_clear_error(&err);
+
+        int rate = g_key_file_get_integer(config, "meters", "rate", &err);
+        if (err || rate <= 0)
+            rate = meterScheduler.getRate();
+        g_clear_error(&err);
+
+        meterScheduler.setRate(rate, g_key_file_get_boolean(config, "meters", "adaptive", NULL));
+
+        router.load(config);
+
+        int fade = g_key_file_get_integer(config, "fades", "mute_duration", &err);
+        if (!err && fade >= 0)
+            fader.setMuteDuration(fade);
+        g_clear_error(&err);
     } else {
         g_debug(_("Error reading config file %s: %s"), m_config_filename, err->message);
         g_error_free(err);
@@ -162,6 +249,14 @@ void MainWindow::on_realize() {
 bool MainWindow::on_key_press_event(GdkEventKey* event) {
 
     if (GDK_KEY_Escape == event->keyval) {
+        int page = notebook->get_current_page();
+
+        /* Escape in a filter entry clears it before closing the window */
+        if (page >= 0 && page < N_PAGES && filterEntries[page].has_focus() && !filterEntries[page].get_text().empty()) {
+            filterEntries[page].set_text("");
+            return true;
+        }
+
         Gtk::Main::quit();
         return true;
     }
@@ -181,6 +276,26 @@ bool MainWindow::on_key_press_event(GdkEventKey* event) {
             case GDK_KEY_5:
                 notebook->set_current_page(event->keyval - GDK_KEY_1);
                 return true;
+            case GDK_KEY_S:
+            case GDK_KEY_s:
+                saveSnapshot();
+                return true;
+            case GDK_KEY_O:
+            case GDK_KEY_o:
+                restoreSnapshot();
+                return true;
+            case GDK_KEY_F:
+            case GDK_KEY_f:
+                if (notebook->get_current_page() >= 0 && notebook->get_current_page() < N_PAGES)
+                    filterEntries[notebook->get_current_page()].grab_focus();
+                return true;
+            case GDK_KEY_Z:
+            case GDK_KEY_z:
+                if (event->state & GDK_SHIFT_MASK)
+                    history.redo();
+                else
+                    history.undo();
+                return true;
             case GDK_KEY_W:
             case GDK_KEY_Q:
             case GDK_KEY_w:
@@ -196,6 +311,9 @@ MainWindow::~MainWindow() {
     GKeyFile* config = g_key_file_new();
     g_assert(config);
 
+    /* Keep whatever else the user put into the file */
+    g_key_file_load_from_file(config, m_config_filename, (GKeyFileFlags)(G_KEY_FILE_KEEP_COMMENTS | G_KEY_FILE_KEEP_TRANSLATIONS), NULL);
+
     int width, height;
     get_size(width, height);
     g_key_file_set_integer(config, "window", "width", width);
@@ -225,11 +343,21 @@ finish:
     g_key_file_free(config);
     g_free(m_config_filename);
 
-    while (!clientNames.empty()) {
-        std::map<uint32_t, char*>::iterator i = clientNames.begin();
-        g_free(i->second);
-        clientNames.erase(i);
-    }
+    buildConnection.disconnect();
+#if HAVE_EXT_DEVICE_RESTORE_API
+    formatReadConnection.disconnect();
+#endif
+
+    for (IndexMap<pa_card_info*>::iterator i = cardInfos.begin(); i != cardInfos.end(); ++i)
+        card_info_free(i->second);
+    for (IndexMap<pa_sink_info*>::iterator i = sinkInfos.begin(); i != sinkInfos.end(); ++i)
+        sink_info_free(i->second);
+    for (IndexMap<pa_source_info*>::iterator i = sourceInfos.begin(); i != sourceInfos.end(); ++i)
+        source_info_free(i->second);
+    for (IndexMap<pa_sink_input_info*>::iterator i = sinkInputInfos.begin(); i != sinkInputInfos.end(); ++i)
+        sink_input_info_free(i->second);
+    for (IndexMap<pa_source_output_info*>::iterator i = sourceOutputInfos.begin(); i != sourceOutputInfos.end(); ++i)
+        source_output_info_free(i->second);
 }
 
 static void set_icon_name_fallback(Gtk::Image *i, const char *name, Gtk::IconSize size) {
@@ -253,18 +381,34 @@ static void set_icon_name_fallback(Gtk::Image *i, const char *name, Gtk::IconSiz
 }
 
 void MainWindow::updateCard(const pa_card_info &info) {
+
+    pa_card_info *&stored = cardInfos.insert(info.index);
+
+    if (stored)
+        card_info_free(stored);
+    stored = card_info_copy(&info);
+
+    if (pageBuilt[PAGE_CONFIGURATION])
+        updateCardWidget(info);
+
+    if (search.update(SearchIndex::CARDS, info.index, info.proplist, info.name) && isFiltering(PAGE_CONFIGURATION))
+        updateDeviceVisibility();
+}
+
+void MainWindow::updateCardWidget(const pa_card_info &info) {
     CardWidget *w;
-    bool is_new = false;
+    bool is_new;
     const char *description, *icon;
     std::set<pa_card_profile_info,profile_prio_compare> profile_priorities;
 
-    if (cardWidgets.count(info.index))
-        w = cardWidgets[info.index];
+    CardWidget *&slot = cardWidgets.insert(info.index, &is_new);
+
+    if (!is_new)
+        w = slot;
     else {
-        cardWidgets[info.index] = w = CardWidget::create();
+        slot = w = CardWidget::create(this);
         cardsVBox->pack_start(*w, false, false, 0);
         w->index = info.index;
-        is_new = true;
     }
 
     w->updating = true;
@@ -299,22 +443,70 @@ void MainWindow::updateCard(const pa_card_info &info) {
 }
 
 bool MainWindow::updateSink(const pa_sink_info &info) {
+    bool is_new, relabel = true, respec = true;
+    pa_sink_info *&stored = sinkInfos.insert(info.index, &is_new);
+
+    if (stored) {
+        relabel = g_strcmp0(stored->description, info.description) != 0;
+        respec = !pa_sample_spec_equal(&stored->sample_spec, &info.sample_spec);
+        sink_info_free(stored);
+    }
+    stored = sink_info_copy(&info);
+
+    if (relabel)
+        sinkMenu.update(info.index, info.description);
+
+    if (relabel || respec)
+        updateSinkStreamLabels(info.index);
+
+    if (respec && sinkInputsBySink.find(info.index))
+        playbackResampling.queueUpdate();
+
+    if (is_new) {
+        GQuark name = g_quark_from_string(info.name);
+
+        sinksByName.insert(name) = info.index;
+        if (name == defaultSinkName)
+            defaultSinkIndex = info.index;
+    }
+
+    if (pageBuilt[PAGE_OUTPUT_DEVICES])
+        updateSinkWidget(info);
+    else if (is_new)
+        updateDeviceVisibility();
+
+    if (search.update(SearchIndex::SINKS, info.index, info.proplist, info.name, info.description) &&
+        (isFiltering(PAGE_OUTPUT_DEVICES) || isFiltering(PAGE_PLAYBACK)))
+        updateDeviceVisibility();
+
+    return is_new;
+}
+
+void MainWindow::updateSinkWidget(const pa_sink_info &info) {
     SinkWidget *w;
-    bool is_new = false;
+    bool is_new;
     const char *icon;
     std::set<pa_sink_port_info,sink_port_prio_compare> port_priorities;
 
-    if (sinkWidgets.count(info.index))
-        w = sinkWidgets[info.index];
+    SinkWidget *&slot = sinkWidgets.insert(info.index, &is_new);
+
+    if (!is_new)
+        w = slot;
     else {
-        sinkWidgets[info.index] = w = SinkWidget::create(this);
+        slot = w = SinkWidget::create(this);
         w->setChannelMap(info.channel_map, !!(info.flags & PA_SINK_DECIBEL_VOLUME));
         sinksVBox->pack_start(*w, false, false, 0);
         w->index = info.index;
         w->monitor_index = info.monitor_source;
-        is_new = true;
 
         w->setBaseVolume(info.base_volume);
+
+        if (pa_context_get_server_protocol_version(get_context()) >= 13 && info.monitor_source != PA_INVALID_INDEX)
+            meterScheduler.addMeter(w, info.monitor_source, PA_INVALID_INDEX, false);
+
+#if HAVE_EXT_DEVICE_RESTORE_API
+        updateSinkFormats(w);
+#endif
     }
 
     w->updating = true;
@@ -333,9 +525,9 @@ bool MainWindow::updateSink(const pa_sink_info &info) {
     set_icon_name_fallback(w->iconImage, icon ? icon : "audio-card", Gtk::ICON_SIZE_SMALL_TOOLBAR);
 
     w->setVolume(info.volume);
-    w->muteToggleButton->set_active(info.mute);
+    w->muteToggleButton->set_active(info.mute || fader.muting(VolumeFader::SINK, info.index));
 
-    w->setDefault(w->name == defaultSinkName);
+    w->setDefault(info.index == defaultSinkIndex);
 
     port_priorities.clear();
     for (uint32_t i=0; i<info.n_ports; ++i) {
@@ -361,20 +553,25 @@ bool MainWindow::updateSink(const pa_sink_info &info) {
 
     if (is_new)
         updateDeviceVisibility();
-
-    return is_new;
 }
 
 static void suspended_callback(pa_stream *s, void *userdata) {
     MainWindow *w = static_cast<MainWindow*>(userdata);
 
     if (pa_stream_is_suspended(s))
-        w->updateVolumeMeter(pa_stream_get_device_index(s), PA_INVALID_INDEX, -1);
+        w->updateVolumeMeter(pa_stream_get_device_index(s), PA_INVALID_INDEX, -1, 0);
 }
 
+/* Integer sample formats never quite reach 1.0 after conversion to float,
+ * so treat anything within 0.01dB of full scale as clipped */
+#define CLIP_THRESHOLD 0.999
+
 static void read_callback(pa_stream *s, size_t length, void *userdata) {
     MainWindow *w = static_cast<MainWindow*>(userdata);
     const void *data;
+    const float *samples;
+    unsigned clipped = 0;
+    size_t n;
     double v;
 
     if (pa_stream_peek(s, &data, &length) < 0) {
@@ -385,7 +582,16 @@ static void read_callback(pa_stream *s, size_t length, void *userdata) {
     assert(length > 0);
     assert(length % sizeof(float) == 0);
 
-    v = ((const float*) data)[length / sizeof(float) -1];
+    samples = (const float*) data;
+    n = length / sizeof(float);
+
+    /* Each value is the peak of a fragment of the monitored audio, so
+     * this counts meter readings at full scale rather than samples */
+    for (size_t i = 0; i < n; i++)
+        if (samples[i] >= CLIP_THRESHOLD)
+            clipped++;
+
+    v = samples[n - 1];
 
     pa_stream_drop(s);
 
@@ -394,7 +600,7 @@ static void read_callback(pa_stream *s, size_t length, void *userdata) {
     if (v > 1)
         v = 1;
 
-    w->updateVolumeMeter(pa_stream_get_device_index(s), pa_stream_get_monitor_stream(s), v);
+    w->updateVolumeMeter(pa_stream_get_device_index(s), pa_stream_get_monitor_stream(s), v, clipped);
 }
 
 pa_stream* MainWindow::createMonitorStreamForSource(uint32_t source_idx, uint32_t stream_idx = -1, bool suspend = false) {
@@ -406,7 +612,7 @@ pa_stream* MainWindow::createMonitorStreamForSource(uint32_t source_idx, uint32_
 
     ss.channels = 1;
     ss.format = PA_SAMPLE_FLOAT32;
-    ss.rate = 25;
+    ss.rate = meterScheduler.getRate();
 
     memset(&attr, 0, sizeof(attr));
     attr.fragsize = sizeof(float);
@@ -426,7 +632,8 @@ pa_stream* MainWindow::createMonitorStreamForSource(uint32_t source_idx, uint32_
     pa_stream_set_suspended_callback(s, suspended_callback, this);
 
     flags = (pa_stream_flags_t) (PA_STREAM_DONT_MOVE | PA_STREAM_PEAK_DETECT | PA_STREAM_ADJUST_LATENCY |
-                                 (suspend ? PA_STREAM_DONT_INHIBIT_AUTO_SUSPEND : PA_STREAM_NOFLAGS));
+                                 (suspend ? PA_STREAM_DONT_INHIBIT_AUTO_SUSPEND : PA_STREAM_NOFLAGS) |
+                                 (meterScheduler.isAdaptive() ? PA_STREAM_VARIABLE_RATE : PA_STREAM_NOFLAGS));
 
     if (pa_stream_connect_record(s, t, &attr, flags) < 0) {
         show_error(_("Failed to connect monitoring stream"));
@@ -437,36 +644,74 @@ pa_stream* MainWindow::createMonitorStreamForSource(uint32_t source_idx, uint32_
 }
 
 void MainWindow::createMonitorStreamForSinkInput(SinkInputWidget* w, uint32_t sink_idx) {
-    if (!sinkWidgets.count(sink_idx))
-        return;
+    pa_sink_info **sink;
 
-    if (w->peak) {
-        pa_stream_disconnect(w->peak);
-        w->peak = NULL;
+    if (!(sink = sinkInfos.find(sink_idx))) {
+        meterScheduler.removeMeter(w);
+        return;
     }
 
-    w->peak = createMonitorStreamForSource(sinkWidgets[sink_idx]->monitor_index, w->index);
+    meterScheduler.addMeter(w, (*sink)->monitor_source, w->index, false);
 }
 
 void MainWindow::updateSource(const pa_source_info &info) {
+    bool is_new, relabel = true, respec = true;
+    pa_source_info *&stored = sourceInfos.insert(info.index, &is_new);
+
+    if (stored) {
+        relabel = g_strcmp0(stored->description, info.description) != 0;
+        respec = !pa_sample_spec_equal(&stored->sample_spec, &info.sample_spec);
+        source_info_free(stored);
+    }
+    stored = source_info_copy(&info);
+
+    if (relabel)
+        sourceMenu.update(info.index, info.description);
+
+    if (relabel || respec)
+        updateSourceStreamLabels(info.index);
+
+    if (respec && sourceOutputsBySource.find(info.index))
+        recordingResampling.queueUpdate();
+
+    if (is_new) {
+        GQuark name = g_quark_from_string(info.name);
+
+        sourcesByName.insert(name) = info.index;
+        if (name == defaultSourceName)
+            defaultSourceIndex = info.index;
+    }
+
+    if (pageBuilt[PAGE_INPUT_DEVICES])
+        updateSourceWidget(info);
+    else if (is_new)
+        updateDeviceVisibility();
+
+    if (search.update(SearchIndex::SOURCES, info.index, info.proplist, info.name, info.description) &&
+        (isFiltering(PAGE_INPUT_DEVICES) || isFiltering(PAGE_RECORDING)))
+        updateDeviceVisibility();
+}
+
+void MainWindow::updateSourceWidget(const pa_source_info &info) {
     SourceWidget *w;
-    bool is_new = false;
+    bool is_new;
     const char *icon;
     std::set<pa_source_port_info,source_port_prio_compare> port_priorities;
 
-    if (sourceWidgets.count(info.index))
-        w = sourceWidgets[info.index];
+    SourceWidget *&slot = sourceWidgets.insert(info.index, &is_new);
+
+    if (!is_new)
+        w = slot;
     else {
-        sourceWidgets[info.index] = w = SourceWidget::create(this);
+        slot = w = SourceWidget::create(this);
         w->setChannelMap(info.channel_map, !!(info.flags & PA_SOURCE_DECIBEL_VOLUME));
         sourcesVBox->pack_start(*w, false, false, 0);
         w->index = info.index;
-        is_new = true;
 
         w->setBaseVolume(info.base_volume);
 
         if (pa_context_get_server_protocol_version(get_context()) >= 13)
-            createMonitorStreamForSource(info.index, -1, !!(info.flags & PA_SOURCE_NETWORK));
+            meterScheduler.addMeter(w, info.index, PA_INVALID_INDEX, !!(info.flags & PA_SOURCE_NETWORK));
     }
 
     w->updating = true;
@@ -485,9 +730,9 @@ void MainWindow::updateSource(const pa_source_info &info) {
     set_icon_name_fallback(w->iconImage, icon ? icon : "audio-input-microphone", Gtk::ICON_SIZE_SMALL_TOOLBAR);
 
     w->setVolume(info.volume);
-    w->muteToggleButton->set_active(info.mute);
+    w->muteToggleButton->set_active(info.mute || fader.muting(VolumeFader::SOURCE, info.index));
 
-    w->setDefault(w->name == defaultSourceName);
+    w->setDefault(info.index == defaultSourceIndex);
 
     port_priorities.clear();
     for (uint32_t i=0; i<info.n_ports; ++i) {
@@ -554,8 +799,6 @@ finish:
 
 void MainWindow::updateSinkInput(const pa_sink_input_info &info) {
     const char *t;
-    SinkInputWidget *w;
-    bool is_new = false;
 
     if ((t = pa_proplist_gets(info.proplist, "module-stream-restore.id"))) {
         if (strcmp(t, "sink-input-by-media-role:event") == 0) {
@@ -564,18 +807,140 @@ void MainWindow::updateSinkInput(const pa_sink_input_info &info) {
         }
     }
 
-    if (sinkInputWidgets.count(info.index)) {
-        w = sinkInputWidgets[info.index];
-        if (pa_context_get_server_protocol_version(get_context()) >= 13)
-            if (w->sinkIndex() != info.sink)
+    bool regroup = true, respec = true, is_new;
+    pa_sink_input_info *&stored = sinkInputInfos.insert(info.index, &is_new);
+
+    if (stored) {
+        regroup = (stored->client == PA_INVALID_INDEX) != (info.client == PA_INVALID_INDEX);
+        respec = stored->sink != info.sink || !pa_sample_spec_equal(&stored->sample_spec, &info.sample_spec) ||
+            g_strcmp0(stored->resample_method, info.resample_method) != 0;
+        if (stored->sink != info.sink) {
+            removeStreamFromDevice(sinkInputsBySink, stored->sink, info.index);
+            regroup = regroup || isFiltering(PAGE_PLAYBACK);
+        }
+        sink_input_info_free(stored);
+    }
+    stored = sink_input_info_copy(&info);
+    if (info.sink != PA_INVALID_INDEX)
+        sinkInputsBySink.insert(info.sink).insert(info.index);
+
+    if (search.update(SearchIndex::SINK_INPUTS, info.index, info.proplist, info.name) && isFiltering(PAGE_PLAYBACK))
+        regroup = true;
+
+    if (respec)
+        playbackResampling.queueUpdate();
+
+    /* Streams already there when we connected stay where the user put them */
+    if (is_new && m_connected)
+        routeSinkInput(info);
+
+    /* Only the rows scrolled into view have a widget, new or reclassified
+     * streams get one once the row list has been rebuilt */
+    if (sinkInputWidgets.find(info.index))
+        updateSinkInputWidget(info);
+
+    if (regroup)
+        updateDeviceVisibility();
+}
+
+static void route_cb(pa_context *c, int success, void *) {
+    if (!success)
+        g_debug(_("Failed to route stream: %s"), pa_strerror(pa_context_errno(c)));
+}
+
+void MainWindow::moveSinkInput(uint32_t index, uint32_t sink) {
+    pa_operation* o;
+
+    history.recordMove(UndoHistory::SINK_INPUT, index, sink);
+
+    if (!(o = pa_context_move_sink_input_by_index(get_context(), index, sink, NULL, NULL))) {
+        show_error(_("pa_context_move_sink_input_by_index() failed"));
+        return;
+    }
+
+    pa_operation_unref(o);
+}
+
+void MainWindow::moveSourceOutput(uint32_t index, uint32_t source) {
+    pa_operation* o;
+
+    history.recordMove(UndoHistory::SOURCE_OUTPUT, index, source);
+
+    if (!(o = pa_context_move_source_output_by_index(get_context(), index, source, NULL, NULL))) {
+        show_error(_("pa_context_move_source_output_by_index() failed"));
+        return;
+    }
+
+    pa_operation_unref(o);
+}
+
+void MainWindow::routeSinkInput(const pa_sink_input_info &info) {
+    const char *target;
+    uint32_t *sink;
+    GQuark q;
+    pa_operation *o;
+
+    if (!(target = router.sinkFor(info.client, clients.name(info.client), info.proplist)))
+        return;
+
+    /* The target may be unplugged right now */
+    if (!(q = g_quark_try_string(target)) || !(sink = sinksByName.find(q)) || *sink == info.sink)
+        return;
+
+    if (!(o = pa_context_move_sink_input_by_index(get_context(), info.index, *sink, route_cb, NULL))) {
+        g_debug(_("pa_context_move_sink_input_by_index() failed"));
+        return;
+    }
+
+    pa_operation_unref(o);
+}
+
+void MainWindow::routeSourceOutput(const pa_source_output_info &info) {
+    const char *target;
+    uint32_t *source;
+    GQuark q;
+    pa_operation *o;
+
+    if (!(target = router.sourceFor(info.client, clients.name(info.client), info.proplist)))
+        return;
+
+    if (!(q = g_quark_try_string(target)) || !(source = sourcesByName.find(q)) || *source == info.source)
+        return;
+
+    if (!(o = pa_context_move_source_output_by_index(get_context(), info.index, *source, route_cb, NULL))) {
+        g_debug(_("pa_context_move_source_output_by_index() failed"));
+        return;
+    }
+
+    pa_operation_unref(o);
+}
+
+void MainWindow::updateSinkInputWidget(const pa_sink_input_info &info) {
+    SinkInputWidget *w;
+    bool is_new;
+
+    SinkInputWidget *&slot = sinkInputWidgets.insert(info.index, &is_new);
+
+    if (!is_new) {
+        w = slot;
+        if (w->sinkIndex() != info.sink) {
+            if (pa_context_get_server_protocol_version(get_context()) >= 13)
                 createMonitorStreamForSinkInput(w, info.sink);
+        }
     } else {
-        sinkInputWidgets[info.index] = w = SinkInputWidget::create(this);
+        if (spareSinkInputWidgets.empty()) {
+            w = SinkInputWidget::create(this);
+            playbackList->pack_start(*w, false, false, 0);
+        } else {
+            w = spareSinkInputWidgets.back();
+            spareSinkInputWidgets.pop_back();
+        }
+
+        slot = w;
         w->setChannelMap(info.channel_map, true);
-        streamsVBox->pack_start(*w, false, false, 0);
         w->index = info.index;
         w->clientIndex = info.client;
-        is_new = true;
+        clients.attach(info.client, w);
 
         if (pa_context_get_server_protocol_version(get_context()) >= 13)
             createMonitorStreamForSinkInput(w, info.sink);
@@ -584,12 +949,14 @@ void MainWindow::updateSinkInput(const pa_sink_input_info &info) {
     w->updating = true;
 
     w->type = info.client != PA_INVALID_INDEX ? SINK_INPUT_CLIENT : SINK_INPUT_VIRTUAL;
+    w->selectButton.set_active(playbackSelection.isSelected(info.index));
 
     w->setSinkIndex(info.sink);
 
+    const char *client;
     char *txt;
-    if (clientNames.count(info.client)) {
-        w->boldNameLabel->set_markup(txt = g_markup_printf_escaped("<b>%s</b>", clientNames[info.client]));
+    if ((client = clients.name(info.client))) {
+        w->boldNameLabel->set_markup(txt = g_markup_printf_escaped("<b>%s</b>", client));
         g_free(txt);
         w->nameLabel->set_markup(txt = g_markup_printf_escaped(": %s", info.name));
         g_free(txt);
@@ -601,45 +968,105 @@ void MainWindow::updateSinkInput(const pa_sink_input_info &info) {
     setIconFromProplist(w->iconImage, info.proplist, "audio-card");
 
     w->setVolume(info.volume);
-    w->muteToggleButton->set_active(info.mute);
+    w->muteToggleButton->set_active(info.mute || fader.muting(VolumeFader::SINK_INPUT, info.index));
 
     w->updating = false;
 
-    if (is_new)
-        updateDeviceVisibility();
+    if (is_new) {
+        if (sinkInfos.size() > 1) {
+            w->directionLabel->show();
+            w->deviceButton->show();
+        } else {
+            w->directionLabel->hide();
+            w->deviceButton->hide();
+        }
+    }
 }
 
 void MainWindow::updateSourceOutput(const pa_source_output_info &info) {
-    SourceOutputWidget *w;
     const char *app;
-    bool is_new = false;
 
     if ((app = pa_proplist_gets(info.proplist, PA_PROP_APPLICATION_ID)))
         if (strcmp(app, "org.PulseAudio.pavucontrol") == 0)
             return;
 
-    if (sourceOutputWidgets.count(info.index))
-        w = sourceOutputWidgets[info.index];
+    bool regroup = true, respec = true, is_new;
+    pa_source_output_info *&stored = sourceOutputInfos.insert(info.index, &is_new);
+
+    if (stored) {
+        regroup = (stored->client == PA_INVALID_INDEX) != (info.client == PA_INVALID_INDEX);
+        respec = stored->source != info.source || !pa_sample_spec_equal(&stored->sample_spec, &info.sample_spec) ||
+            g_strcmp0(stored->resample_method, info.resample_method) != 0;
+        if (stored->source != info.source) {
+            removeStreamFromDevice(sourceOutputsBySource, stored->source, info.index);
+            regroup = regroup || isFiltering(PAGE_RECORDING);
+        }
+        source_output_info_free(stored);
+    }
+    stored = source_output_info_copy(&info);
+    if (info.source != PA_INVALID_INDEX)
+        sourceOutputsBySource.insert(info.source).insert(info.index);
+
+    if (search.update(SearchIndex::SOURCE_OUTPUTS, info.index, info.proplist, info.name) && isFiltering(PAGE_RECORDING))
+        regroup = true;
+
+    if (respec)
+        recordingResampling.queueUpdate();
+
+    if (is_new && m_connected)
+        routeSourceOutput(info);
+
+    if (sourceOutputWidgets.find(info.index))
+        updateSourceOutputWidget(info);
+
+    if (regroup)
+        updateDeviceVisibility();
+}
+
+void MainWindow::updateSourceOutputWidget(const pa_source_output_info &info) {
+    SourceOutputWidget *w;
+    bool is_new;
+
+    SourceOutputWidget *&slot = sourceOutputWidgets.insert(info.index, &is_new);
+
+    if (!is_new)
+        w = slot;
     else {
-        sourceOutputWidgets[info.index] = w = SourceOutputWidget::create(this);
+        if (spareSourceOutputWidgets.empty()) {
+            w = SourceOutputWidget::create(this);
+            recordingList->pack_start(*w, false, false, 0);
+        } else {
+            w = spareSourceOutputWidgets.back();
+            spareSourceOutputWidgets.pop_back();
+        }
+
+        slot = w;
 #if HAVE_SOURCE_OUTPUT_VOLUMES
         w->setChannelMap(info.channel_map, true);
 #endif
-        recsVBox->pack_start(*w, false, false, 0);
         w->index = info.index;
         w->clientIndex = info.client;
-        is_new = true;
+        clients.attach(info.client, w);
+    }
+
+    /* Source outputs show the level of their source, so they only tell
+     * the scheduler which source meters are on screen */
+    if (is_new || w->sourceIndex() != info.source) {
+        if (pa_context_get_server_protocol_version(get_context()) >= 13)
+            meterScheduler.addMeter(w, info.source, PA_INVALID_INDEX, false);
     }
 
     w->updating = true;
 
     w->type = info.client != PA_INVALID_INDEX ? SOURCE_OUTPUT_CLIENT : SOURCE_OUTPUT_VIRTUAL;
+    w->selectButton.set_active(recordingSelection.isSelected(info.index));
 
     w->setSourceIndex(info.source);
 
+    const char *client;
     char *txt;
-    if (clientNames.count(info.client)) {
-        w->boldNameLabel->set_markup(txt = g_markup_printf_escaped("<b>%s</b>", clientNames[info.client]));
+    if ((client = clients.name(info.client))) {
+        w->boldNameLabel->set_markup(txt = g_markup_printf_escaped("<b>%s</b>", client));
         g_free(txt);
         w->nameLabel->set_markup(txt = g_markup_printf_escaped(": %s", info.name));
         g_free(txt);
@@ -652,60 +1079,96 @@ void MainWindow::updateSourceOutput(const pa_source_output_info &info) {
 
 #if HAVE_SOURCE_OUTPUT_VOLUMES
     w->setVolume(info.volume);
-    w->muteToggleButton->set_active(info.mute);
+    w->muteToggleButton->set_active(info.mute || fader.muting(VolumeFader::SOURCE_OUTPUT, info.index));
 #endif
 
     w->updating = false;
 
-    if (is_new)
-        updateDeviceVisibility();
+    if (is_new) {
+        if (sourceInfos.size() > 1) {
+            w->directionLabel->show();
+            w->deviceButton->show();
+        } else {
+            w->directionLabel->hide();
+            w->deviceButton->hide();
+        }
+    }
 }
 
 void MainWindow::updateClient(const pa_client_info &info) {
 
-    g_free(clientNames[info.index]);
-    clientNames[info.index] = g_strdup(info.name);
+    const ClientRegistry::StreamSet *streams;
 
-    for (std::map<uint32_t, SinkInputWidget*>::iterator i = sinkInputWidgets.begin(); i != sinkInputWidgets.end(); ++i) {
-        SinkInputWidget *w = i->second;
+    clients.update(info.index, info.name);
 
-        if (!w)
-            continue;
+    if (search.update(SearchIndex::CLIENTS, info.index, info.proplist, info.name) &&
+        (isFiltering(PAGE_PLAYBACK) || isFiltering(PAGE_RECORDING)))
+        updateDeviceVisibility();
 
-        if (w->clientIndex == info.index) {
-            gchar *txt;
-            w->boldNameLabel->set_markup(txt = g_markup_printf_escaped("<b>%s</b>", info.name));
-            g_free(txt);
-        }
+    if (!(streams = clients.streams(info.index)))
+        return;
+
+    for (ClientRegistry::StreamSet::const_iterator i = streams->begin(); i != streams->end(); ++i) {
+        gchar *txt;
+        (*i)->boldNameLabel->set_markup(txt = g_markup_printf_escaped("<b>%s</b>", info.name));
+        g_free(txt);
     }
 }
 
 void MainWindow::updateServer(const pa_server_info &info) {
 
-    defaultSourceName = info.default_source_name ? info.default_source_name : "";
-    defaultSinkName = info.default_sink_name ? info.default_sink_name : "";
+    uint32_t *index;
 
-    for (std::map<uint32_t, SinkWidget*>::iterator i = sinkWidgets.begin(); i != sinkWidgets.end(); ++i) {
-        SinkWidget *w = i->second;
+    defaultSourceName = g_quark_from_string(info.default_source_name ? info.default_source_name : "");
+    defaultSinkName = g_quark_from_string(info.default_sink_name ? info.default_sink_name : "");
 
-        if (!w)
-            continue;
+    index = sinksByName.find(defaultSinkName);
+    setDefaultSink(index ? *index : PA_INVALID_INDEX);
 
-        w->updating = true;
-        w->setDefault(w->name == defaultSinkName);
+    index = sourcesByName.find(defaultSourceName);
+    setDefaultSource(index ? *index : PA_INVALID_INDEX);
+}
+
+/* Only the widgets of the old and the new default device change */
+void MainWindow::setDefaultSink(uint32_t index) {
+    SinkWidget **w;
+
+    if (index == defaultSinkIndex)
+        return;
 
-        w->updating = false;
+    if ((w = sinkWidgets.find(defaultSinkIndex))) {
+        (*w)->updating = true;
+        (*w)->setDefault(false);
+        (*w)->updating = false;
     }
 
-    for (std::map<uint32_t, SourceWidget*>::iterator i = sourceWidgets.begin(); i != sourceWidgets.end(); ++i) {
-        SourceWidget *w = i->second;
+    defaultSinkIndex = index;
 
-        if (!w)
-            continue;
+    if ((w = sinkWidgets.find(defaultSinkIndex))) {
+        (*w)->updating = true;
+        (*w)->setDefault(true);
+        (*w)->updating = false;
+    }
+}
+
+void MainWindow::setDefaultSource(uint32_t index) {
+    SourceWidget **w;
+
+    if (index == defaultSourceIndex)
+        return;
+
+    if ((w = sourceWidgets.find(defaultSourceIndex))) {
+        (*w)->updating = true;
+        (*w)->setDefault(false);
+        (*w)->updating = false;
+    }
+
+    defaultSourceIndex = index;
 
-        w->updating = true;
-        w->setDefault(w->name == defaultSourceName);
-        w->updating = false;
+    if ((w = sourceWidgets.find(defaultSourceIndex))) {
+        (*w)->updating = true;
+        (*w)->setDefault(true);
+        (*w)->updating = false;
     }
 }
 
@@ -718,7 +1181,9 @@ bool MainWindow::createEventRoleWidget() {
     };
 
     eventRoleWidget = RoleWidget::create();
+    eventRoleWidget->init(this);
     streamsVBox->pack_start(*eventRoleWidget, false, false, 0);
+    streamsVBox->reorder_child(*eventRoleWidget, 1);
     eventRoleWidget->role = "sink-input-by-media-role:event";
     eventRoleWidget->setChannelMap(cm, true);
 
@@ -745,6 +1210,8 @@ bool MainWindow::createEventRoleWidget() {
 
 void MainWindow::deleteEventRoleWidget() {
 
+    fader.cancel(VolumeFader::EVENT_ROLE, 0);
+
     if (eventRoleWidget)
         delete eventRoleWidget;
 
@@ -768,7 +1235,7 @@ void MainWindow::updateRole(const pa_ext_stream_restore_info &info) {
     volume.values[0] = pa_cvolume_max(&info.volume);
 
     eventRoleWidget->setVolume(volume);
-    eventRoleWidget->muteToggleButton->set_active(info.mute);
+    eventRoleWidget->muteToggleButton->set_active(info.mute || fader.muting(VolumeFader::EVENT_ROLE, 0));
 
     eventRoleWidget->updating = false;
 
@@ -779,70 +1246,307 @@ void MainWindow::updateRole(const pa_ext_stream_restore_info &info) {
 #if HAVE_EXT_DEVICE_RESTORE_API
 void MainWindow::updateDeviceInfo(const pa_ext_device_restore_info &info) {
 
-    if (sinkWidgets.count(info.index)) {
-        SinkWidget *w;
-        pa_format_info *format;
+    SinkWidget **w;
 
-        w = sinkWidgets[info.index];
+    if (!sinkInfos.find(info.index))
+        return;
 
-        w->updating = true;
+    std::vector<pa_encoding_t> received;
+    bool is_new;
 
-        /* Unselect everything */
-        for (int j = 1; j < PAVU_NUM_ENCODINGS; ++j)
-            w->encodings[j].widget->set_active(false);
+    for (uint8_t i = 0; i < info.n_formats; ++i)
+        received.push_back(info.formats[i]->encoding);
 
+    std::vector<pa_encoding_t> &encodings = sinkFormats.insert(info.index, &is_new);
 
-        for (uint8_t i = 0; i < info.n_formats; ++i) {
-            format = info.formats[i];
-            for (int j = 1; j < PAVU_NUM_ENCODINGS; ++j) {
-                if (format->encoding == w->encodings[j].encoding) {
-                    w->encodings[j].widget->set_active(true);
-                    break;
-                }
-            }
+    if (!is_new && encodings == received)
+        return;
+
+    encodings.swap(received);
+
+    if ((w = sinkWidgets.find(info.index)))
+        updateSinkFormats(*w);
+}
+
+static void device_restore_read_cb(pa_context *, const pa_ext_device_restore_info *i, int eol, void *userdata) {
+    MainWindow *w = static_cast<MainWindow*>(userdata);
+
+    if (eol < 0) {
+        g_debug(_("Failed to read the formats of a sink: %s"), pa_strerror(pa_context_errno(get_context())));
+        return;
+    }
+
+    if (eol > 0)
+        return;
+
+    w->updateDeviceInfo(*i);
+}
+
+/* New sinks and device-restore notifications only queue the sink, the
+ * reads go out once per main loop iteration with duplicates dropped */
+void MainWindow::queueFormatRead(uint32_t index) {
+    pa_sink_info **info;
+
+    if (!(info = sinkInfos.find(index)))
+        return;
+
+#ifdef PA_SINK_SET_FORMATS
+    /* Nothing to show for sinks that do not take formats */
+    if (!((*info)->flags & PA_SINK_SET_FORMATS))
+        return;
+#endif
+
+    pendingFormatReads.insert(index);
+
+    if (!formatReadConnection.connected())
+        formatReadConnection = Glib::signal_idle().connect(sigc::mem_fun(*this, &MainWindow::onFormatReadIdle));
+}
+
+bool MainWindow::onFormatReadIdle() {
+    std::set<uint32_t> pending;
+
+    pending.swap(pendingFormatReads);
+
+    for (std::set<uint32_t>::iterator i = pending.begin(); i != pending.end(); ++i) {
+        pa_operation *o;
+
+        /* The sink may have gone away since it was queued */
+        if (!sinkInfos.find(*i))
+            continue;
+
+        if (!(o = pa_ext_device_restore_read_formats(get_context(), PA_DEVICE_TYPE_SINK, *i, device_restore_read_cb, this))) {
+            show_error(_("pa_ext_device_restore_read_sink_formats() failed"));
+            return false;
         }
 
-        w->updating = false;
+        pa_operation_unref(o);
+    }
+
+    return false;
+}
+
+void MainWindow::updateSinkFormats(SinkWidget *w) {
+    std::vector<pa_encoding_t> *encodings;
+
+    if (!(encodings = sinkFormats.find(w->index)))
+        return;
+
+    w->updating = true;
+
+    /* Unselect everything */
+    for (int j = 1; j < PAVU_NUM_ENCODINGS; ++j)
+        w->encodings[j].widget->set_active(false);
+
+    for (std::vector<pa_encoding_t>::iterator e = encodings->begin(); e != encodings->end(); ++e) {
+        for (int j = 1; j < PAVU_NUM_ENCODINGS; ++j) {
+            if (*e == w->encodings[j].encoding) {
+                w->encodings[j].widget->set_active(true);
+                break;
+            }
+        }
     }
+
+    w->updating = false;
 }
 #endif
 
 
-void MainWindow::updateVolumeMeter(uint32_t source_index, uint32_t sink_input_idx, double v) {
+void MainWindow::updateVolumeMeter(uint32_t source_index, uint32_t sink_input_idx, double v, unsigned clipped) {
+
+    meterScheduler.noteLevel(source_index, sink_input_idx, v);
 
     if (sink_input_idx != PA_INVALID_INDEX) {
-        SinkInputWidget *w;
+        SinkInputWidget **p, *w;
 
-        if (sinkInputWidgets.count(sink_input_idx)) {
-            w = sinkInputWidgets[sink_input_idx];
+        if ((p = sinkInputWidgets.find(sink_input_idx))) {
+            w = *p;
             w->updatePeak(v);
+
+            if (clipped) {
+                w->updateClip(clipped);
+                w->clipEvent = clipLog.record(w->clipEvent, "sink-input", w->index,
+                                              w->boldNameLabel->get_text() + w->nameLabel->get_text(), clipped);
+            }
         }
 
     } else {
+        bool sinkLogged = false;
 
-        for (std::map<uint32_t, SinkWidget*>::iterator i = sinkWidgets.begin(); i != sinkWidgets.end(); ++i) {
+        for (IndexMap<SinkWidget*>::iterator i = sinkWidgets.begin(); i != sinkWidgets.end(); ++i) {
             SinkWidget* w = i->second;
 
-            if (w->monitor_index == source_index)
+            if (w->monitor_index == source_index) {
                 w->updatePeak(v);
+
+                if (clipped) {
+                    w->updateClip(clipped);
+                    w->clipEvent = clipLog.record(w->clipEvent, "sink", w->index, w->description, clipped);
+                    sinkLogged = true;
+                }
+            }
         }
 
-        for (std::map<uint32_t, SourceWidget*>::iterator i = sourceWidgets.begin(); i != sourceWidgets.end(); ++i) {
+        for (IndexMap<SourceWidget*>::iterator i = sourceWidgets.begin(); i != sourceWidgets.end(); ++i) {
             SourceWidget* w = i->second;
 
-            if (w->index == source_index)
+            if (w->index == source_index) {
                 w->updatePeak(v);
+
+                if (!clipped)
+                    continue;
+
+                w->updateClip(clipped);
+
+                if (w->type != SOURCE_MONITOR)
+                    w->clipEvent = clipLog.record(w->clipEvent, "source", w->index, w->description, clipped);
+                else if (!sinkLogged) {
+                    /* A monitor source carries the same signal as its
+                     * sink, logged against the sink unless the Output
+                     * Devices page already did */
+                    for (IndexMap<pa_sink_info*>::iterator j = sinkInfos.begin(); j != sinkInfos.end(); ++j)
+                        if (j->second->monitor_source == source_index) {
+                            w->clipEvent = clipLog.record(w->clipEvent, "sink", j->second->index, j->second->description, clipped);
+                            break;
+                        }
+                }
+            }
         }
 
-        for (std::map<uint32_t, SourceOutputWidget*>::iterator i = sourceOutputWidgets.begin(); i != sourceOutputWidgets.end(); ++i) {
+        for (IndexMap<SourceOutputWidget*>::iterator i = sourceOutputWidgets.begin(); i != sourceOutputWidgets.end(); ++i) {
             SourceOutputWidget* w = i->second;
 
-            if (w->sourceIndex() == source_index)
+            if (w->sourceIndex() == source_index) {
                 w->updatePeak(v);
+
+                if (clipped)
+                    w->updateClip(clipped);
+            }
         }
     }
 }
 
+void MainWindow::saveClipLog() {
+    Gtk::FileChooserDialog dialog(*this, _("Save Clip Log"), Gtk::FILE_CHOOSER_ACTION_SAVE);
+    GError *err = NULL;
+
+    dialog.add_button(Gtk::Stock::CANCEL, Gtk::RESPONSE_CANCEL);
+    dialog.add_button(Gtk::Stock::SAVE, Gtk::RESPONSE_OK);
+    dialog.set_default_response(Gtk::RESPONSE_OK);
+    dialog.set_do_overwrite_confirmation(true);
+    dialog.set_current_name("pavucontrol-clips.log");
+
+    if (dialog.run() != Gtk::RESPONSE_OK)
+        return;
+
+    std::string filename = dialog.get_filename();
+    Glib::ustring data = clipLog.toString();
+
+    dialog.hide();
+
+    if (!g_file_set_contents(filename.c_str(), data.c_str(), data.bytes(), &err)) {
+        Gtk::MessageDialog error(
+            *this,
+            _("Failed to save the clip log."),
+            false,
+            Gtk::MESSAGE_WARNING,
+            Gtk::BUTTONS_OK,
+            true);
+        error.set_secondary_text(err->message);
+        error.run();
+        g_error_free(err);
+    }
+}
+
+void MainWindow::saveSnapshot() {
+    Gtk::FileChooserDialog dialog(*this, _("Save Mixer Snapshot"), Gtk::FILE_CHOOSER_ACTION_SAVE);
+    GError *err = NULL;
+
+    dialog.add_button(Gtk::Stock::CANCEL, Gtk::RESPONSE_CANCEL);
+    dialog.add_button(Gtk::Stock::SAVE, Gtk::RESPONSE_OK);
+    dialog.set_default_response(Gtk::RESPONSE_OK);
+    dialog.set_do_overwrite_confirmation(true);
+    dialog.set_current_name("pavucontrol-snapshot.json");
+
+    if (dialog.run() != Gtk::RESPONSE_OK)
+        return;
+
+    std::string filename = dialog.get_filename();
+    std::string data = snapshot.capture();
+
+    dialog.hide();
+
+    if (!g_file_set_contents(filename.c_str(), data.c_str(), data.size(), &err)) {
+        Gtk::MessageDialog error(
+            *this,
+            _("Failed to save the mixer snapshot."),
+            false,
+            Gtk::MESSAGE_WARNING,
+            Gtk::BUTTONS_OK,
+            true);
+        error.set_secondary_text(err->message);
+        error.run();
+        g_error_free(err);
+    }
+}
+
+void MainWindow::restoreSnapshot() {
+    Gtk::FileChooserDialog dialog(*this, _("Restore Mixer Snapshot"), Gtk::FILE_CHOOSER_ACTION_OPEN);
+    GError *err = NULL;
+    std::string error;
+    gchar *data;
+    gsize length;
+
+    dialog.add_button(Gtk::Stock::CANCEL, Gtk::RESPONSE_CANCEL);
+    dialog.add_button(Gtk::Stock::OPEN, Gtk::RESPONSE_OK);
+    dialog.set_default_response(Gtk::RESPONSE_OK);
+
+    if (dialog.run() != Gtk::RESPONSE_OK)
+        return;
+
+    std::string filename = dialog.get_filename();
+
+    dialog.hide();
+
+    if (!g_file_get_contents(filename.c_str(), &data, &length, &err)) {
+        error = err->message;
+        g_error_free(err);
+    } else {
+        bool ok = snapshot.restore(std::string(data, length), sigc::mem_fun(*this, &MainWindow::onSnapshotRestored), &error);
+        g_free(data);
+
+        if (ok)
+            return;
+    }
+
+    Gtk::MessageDialog dlg(
+        *this,
+        _("Failed to restore the mixer snapshot."),
+        false,
+        Gtk::MESSAGE_WARNING,
+        Gtk::BUTTONS_OK,
+        true);
+    dlg.set_secondary_text(error);
+    dlg.run();
+}
+
+void MainWindow::onSnapshotRestored(unsigned operations, unsigned failed) {
+    gchar *txt;
+
+    if (failed == 0)
+        return;
+
+    Gtk::MessageDialog dialog(
+        *this,
+        _("The mixer snapshot was only partly restored."),
+        false,
+        Gtk::MESSAGE_WARNING,
+        Gtk::BUTTONS_OK,
+        true);
+    dialog.set_secondary_text(txt = g_strdup_printf(_("%u of %u changes could not be made, the devices they were for may be missing."), failed, operations));
+    g_free(txt);
+    dialog.run();
+}
+
 static guint idle_source = 0;
 
 gboolean idle_cb(gpointer data) {
@@ -875,27 +1579,40 @@ void MainWindow::updateDeviceVisibility() {
 void MainWindow::reallyUpdateDeviceVisibility() {
     bool is_empty = true;
 
-    for (std::map<uint32_t, SinkInputWidget*>::iterator i = sinkInputWidgets.begin(); i != sinkInputWidgets.end(); ++i) {
+    playbackRows.clear();
+    for (IndexMap<pa_sink_input_info*>::iterator i = sinkInputInfos.begin(); i != sinkInputInfos.end(); ++i) {
+        SinkInputType type = i->second->client != PA_INVALID_INDEX ? SINK_INPUT_CLIENT : SINK_INPUT_VIRTUAL;
+
+        if ((showSinkInputType == SINK_INPUT_ALL || type == showSinkInputType) &&
+            search.matches(SearchIndex::SINK_INPUTS, i->first, filterTerms[PAGE_PLAYBACK], i->second->client, i->second->sink))
+            playbackRows.push_back(i->first);
+    }
+
+    for (IndexMap<SinkInputWidget*>::iterator i = sinkInputWidgets.begin(); i != sinkInputWidgets.end(); ++i) {
         SinkInputWidget* w = i->second;
 
-        if (sinkWidgets.size() > 1) {
+        if (sinkInfos.size() > 1) {
             w->directionLabel->show();
             w->deviceButton->show();
         } else {
             w->directionLabel->hide();
             w->deviceButton->hide();
         }
+    }
 
-        if (showSinkInputType == SINK_INPUT_ALL || w->type == showSinkInputType) {
-            w->show();
+    if (pageBuilt[PAGE_PLAYBACK]) {
+        playbackList->setRowCount(playbackRows.size());
+        is_empty = playbackRows.empty();
+    }
+
+    if (eventRoleWidget) {
+        if (SearchIndex::matches(_("System Sounds"), filterTerms[PAGE_PLAYBACK])) {
+            eventRoleWidget->show();
             is_empty = false;
         } else
-            w->hide();
+            eventRoleWidget->hide();
     }
 
-    if (eventRoleWidget)
-        is_empty = false;
-
     if (is_empty)
         noStreamsLabel->show();
     else
@@ -903,22 +1620,30 @@ void MainWindow::reallyUpdateDeviceVisibility() {
 
     is_empty = true;
 
-    for (std::map<uint32_t, SourceOutputWidget*>::iterator i = sourceOutputWidgets.begin(); i != sourceOutputWidgets.end(); ++i) {
+    recordingRows.clear();
+    for (IndexMap<pa_source_output_info*>::iterator i = sourceOutputInfos.begin(); i != sourceOutputInfos.end(); ++i) {
+        SourceOutputType type = i->second->client != PA_INVALID_INDEX ? SOURCE_OUTPUT_CLIENT : SOURCE_OUTPUT_VIRTUAL;
+
+        if ((showSourceOutputType == SOURCE_OUTPUT_ALL || type == showSourceOutputType) &&
+            search.matches(SearchIndex::SOURCE_OUTPUTS, i->first, filterTerms[PAGE_RECORDING], i->second->client, i->second->source))
+            recordingRows.push_back(i->first);
+    }
+
+    for (IndexMap<SourceOutputWidget*>::iterator i = sourceOutputWidgets.begin(); i != sourceOutputWidgets.end(); ++i) {
         SourceOutputWidget* w = i->second;
 
-        if (sourceWidgets.size() > 1) {
+        if (sourceInfos.size() > 1) {
             w->directionLabel->show();
             w->deviceButton->show();
         } else {
             w->directionLabel->hide();
             w->deviceButton->hide();
         }
+    }
 
-        if (showSourceOutputType == SOURCE_OUTPUT_ALL || w->type == showSourceOutputType) {
-            w->show();
-            is_empty = false;
-        } else
-            w->hide();
+    if (pageBuilt[PAGE_RECORDING]) {
+        recordingList->setRowCount(recordingRows.size());
+        is_empty = recordingRows.empty();
     }
 
     if (is_empty)
@@ -928,10 +1653,11 @@ void MainWindow::reallyUpdateDeviceVisibility() {
 
     is_empty = true;
 
-    for (std::map<uint32_t, SinkWidget*>::iterator i = sinkWidgets.begin(); i != sinkWidgets.end(); ++i) {
+    for (IndexMap<SinkWidget*>::iterator i = sinkWidgets.begin(); i != sinkWidgets.end(); ++i) {
         SinkWidget* w = i->second;
 
-        if (showSinkType == SINK_ALL || w->type == showSinkType) {
+        if ((showSinkType == SINK_ALL || w->type == showSinkType) &&
+            search.matches(SearchIndex::SINKS, i->first, filterTerms[PAGE_OUTPUT_DEVICES])) {
             w->show();
             is_empty = false;
         } else
@@ -945,11 +1671,14 @@ void MainWindow::reallyUpdateDeviceVisibility() {
 
     is_empty = true;
 
-    for (std::map<uint32_t, CardWidget*>::iterator i = cardWidgets.begin(); i != cardWidgets.end(); ++i) {
+    for (IndexMap<CardWidget*>::iterator i = cardWidgets.begin(); i != cardWidgets.end(); ++i) {
         CardWidget* w = i->second;
 
-        w->show();
-        is_empty = false;
+        if (search.matches(SearchIndex::CARDS, i->first, filterTerms[PAGE_CONFIGURATION])) {
+            w->show();
+            is_empty = false;
+        } else
+            w->hide();
     }
 
     if (is_empty)
@@ -959,12 +1688,13 @@ void MainWindow::reallyUpdateDeviceVisibility() {
 
     is_empty = true;
 
-    for (std::map<uint32_t, SourceWidget*>::iterator i = sourceWidgets.begin(); i != sourceWidgets.end(); ++i) {
+    for (IndexMap<SourceWidget*>::iterator i = sourceWidgets.begin(); i != sourceWidgets.end(); ++i) {
         SourceWidget* w = i->second;
 
-        if (showSourceType == SOURCE_ALL ||
-            w->type == showSourceType ||
-            (showSourceType == SOURCE_NO_MONITOR && w->type != SOURCE_MONITOR)) {
+        if ((showSourceType == SOURCE_ALL ||
+             w->type == showSourceType ||
+             (showSourceType == SOURCE_NO_MONITOR && w->type != SOURCE_MONITOR)) &&
+            search.matches(SearchIndex::SOURCES, i->first, filterTerms[PAGE_INPUT_DEVICES])) {
             w->show();
             is_empty = false;
         } else
@@ -991,71 +1721,347 @@ void MainWindow::reallyUpdateDeviceVisibility() {
 }
 
 void MainWindow::removeCard(uint32_t index) {
-    if (!cardWidgets.count(index))
+    pa_card_info **info;
+    CardWidget **w;
+
+    if (!(info = cardInfos.find(index)))
         return;
 
-    delete cardWidgets[index];
-    cardWidgets.erase(index);
+    card_info_free(*info);
+    cardInfos.erase(index);
+    search.remove(SearchIndex::CARDS, index);
+
+    if ((w = cardWidgets.find(index))) {
+        delete *w;
+        cardWidgets.erase(index);
+    }
+
     updateDeviceVisibility();
 }
 
 void MainWindow::removeSink(uint32_t index) {
-    if (!sinkWidgets.count(index))
+    pa_sink_info **info;
+    SinkWidget **w;
+
+    if (!(info = sinkInfos.find(index)))
         return;
 
-    delete sinkWidgets[index];
-    sinkWidgets.erase(index);
+    fader.cancel(VolumeFader::SINK, index);
+    sinksByName.erase(g_quark_from_string((*info)->name));
+    if (index == defaultSinkIndex)
+        defaultSinkIndex = PA_INVALID_INDEX;
+
+    sink_info_free(*info);
+    sinkInfos.erase(index);
+    search.remove(SearchIndex::SINKS, index);
+
+    sinkMenu.remove(index);
+    updateSinkStreamLabels(index);
+
+#if HAVE_EXT_DEVICE_RESTORE_API
+    sinkFormats.erase(index);
+#endif
+
+    if ((w = sinkWidgets.find(index))) {
+        delete *w;
+        sinkWidgets.erase(index);
+    }
+
     updateDeviceVisibility();
 }
 
 void MainWindow::removeSource(uint32_t index) {
-    if (!sourceWidgets.count(index))
+    pa_source_info **info;
+    SourceWidget **w;
+
+    if (!(info = sourceInfos.find(index)))
         return;
 
-    delete sourceWidgets[index];
-    sourceWidgets.erase(index);
+    fader.cancel(VolumeFader::SOURCE, index);
+    sourcesByName.erase(g_quark_from_string((*info)->name));
+    if (index == defaultSourceIndex)
+        defaultSourceIndex = PA_INVALID_INDEX;
+
+    source_info_free(*info);
+    sourceInfos.erase(index);
+    search.remove(SearchIndex::SOURCES, index);
+
+    sourceMenu.remove(index);
+    updateSourceStreamLabels(index);
+
+    if ((w = sourceWidgets.find(index))) {
+        delete *w;
+        sourceWidgets.erase(index);
+    }
+
     updateDeviceVisibility();
 }
 
 void MainWindow::removeSinkInput(uint32_t index) {
-    if (!sinkInputWidgets.count(index))
+    pa_sink_input_info **info;
+    SinkInputWidget **w;
+
+    if (!(info = sinkInputInfos.find(index)))
         return;
 
-    delete sinkInputWidgets[index];
-    sinkInputWidgets.erase(index);
+    fader.cancel(VolumeFader::SINK_INPUT, index);
+    removeStreamFromDevice(sinkInputsBySink, (*info)->sink, index);
+    sink_input_info_free(*info);
+    sinkInputInfos.erase(index);
+    search.remove(SearchIndex::SINK_INPUTS, index);
+    playbackResampling.queueUpdate();
+    playbackSelection.remove(index);
+
+    if ((w = sinkInputWidgets.find(index))) {
+        releaseSinkInputWidget(*w);
+        sinkInputWidgets.erase(index);
+    }
+
     updateDeviceVisibility();
 }
 
 void MainWindow::removeSourceOutput(uint32_t index) {
-    if (!sourceOutputWidgets.count(index))
+    pa_source_output_info **info;
+    SourceOutputWidget **w;
+
+    if (!(info = sourceOutputInfos.find(index)))
         return;
 
-    delete sourceOutputWidgets[index];
-    sourceOutputWidgets.erase(index);
+    fader.cancel(VolumeFader::SOURCE_OUTPUT, index);
+    removeStreamFromDevice(sourceOutputsBySource, (*info)->source, index);
+    source_output_info_free(*info);
+    sourceOutputInfos.erase(index);
+    search.remove(SearchIndex::SOURCE_OUTPUTS, index);
+    recordingResampling.queueUpdate();
+    recordingSelection.remove(index);
+
+    if ((w = sourceOutputWidgets.find(index))) {
+        releaseSourceOutputWidget(*w);
+        sourceOutputWidgets.erase(index);
+    }
+
     updateDeviceVisibility();
 }
 
+void MainWindow::removeStreamFromDevice(IndexMap<std::set<uint32_t> > &byDevice, uint32_t device, uint32_t stream) {
+    std::set<uint32_t> *streams;
+
+    if (!(streams = byDevice.find(device)))
+        return;
+
+    streams->erase(stream);
+    if (streams->empty())
+        byDevice.erase(device);
+}
+
 void MainWindow::removeClient(uint32_t index) {
-    g_free(clientNames[index]);
-    clientNames.erase(index);
+    clients.remove(index);
+    router.removeClient(index);
+    search.remove(SearchIndex::CLIENTS, index);
 }
 
 void MainWindow::removeAllWidgets() {
-    for (std::map<uint32_t, SinkInputWidget*>::iterator it = sinkInputWidgets.begin(); it != sinkInputWidgets.end(); ++it)
-        removeSinkInput(it->first);
-    for (std::map<uint32_t, SourceOutputWidget*>::iterator it = sourceOutputWidgets.begin(); it != sourceOutputWidgets.end(); ++it)
-        removeSourceOutput(it->first);
-    for (std::map<uint32_t, SinkWidget*>::iterator it = sinkWidgets.begin(); it != sinkWidgets.end(); ++it)
-        removeSink(it->first);
-    for (std::map<uint32_t, SourceWidget*>::iterator it = sourceWidgets.begin(); it != sourceWidgets.end(); ++it)
-        removeSource(it->first);
-    for (std::map<uint32_t, CardWidget*>::iterator it = cardWidgets.begin(); it != cardWidgets.end(); ++it)
-       removeCard(it->first);
-    for (std::map<uint32_t, char*>::iterator it = clientNames.begin(); it != clientNames.end(); ++it)
-        removeClient(it->first);
+    for (IndexMap<pa_sink_input_info*>::iterator i = sinkInputInfos.begin(); i != sinkInputInfos.end(); ++i)
+        removeSinkInput(i->first);
+    for (IndexMap<pa_source_output_info*>::iterator i = sourceOutputInfos.begin(); i != sourceOutputInfos.end(); ++i)
+        removeSourceOutput(i->first);
+    for (IndexMap<pa_sink_info*>::iterator i = sinkInfos.begin(); i != sinkInfos.end(); ++i)
+        removeSink(i->first);
+    for (IndexMap<pa_source_info*>::iterator i = sourceInfos.begin(); i != sourceInfos.end(); ++i)
+        removeSource(i->first);
+    for (IndexMap<pa_card_info*>::iterator i = cardInfos.begin(); i != cardInfos.end(); ++i)
+        removeCard(i->first);
+    clients.clear();
+    search.clear();
+    streamRestore.clear();
+    fader.clear();
+    history.clear();
+    playbackSelection.cancel();
+    recordingSelection.cancel();
+    snapshot.cancel();
+    DeviceDrain::cancel();
+    controlSocket.cancel();
+#if HAVE_EXT_DEVICE_RESTORE_API
+    formatReadConnection.disconnect();
+    pendingFormatReads.clear();
+#endif
     deleteEventRoleWidget();
 }
 
+void MainWindow::bindPlaybackRows(unsigned first, unsigned last) {
+    std::set<uint32_t> wanted(playbackRows.begin() + first, playbackRows.begin() + last);
+
+    for (IndexMap<SinkInputWidget*>::iterator i = sinkInputWidgets.begin(); i != sinkInputWidgets.end();) {
+        if (wanted.count(i->first)) {
+            ++i;
+            continue;
+        }
+
+        releaseSinkInputWidget(i->second);
+        sinkInputWidgets.erase((i++)->first);
+    }
+
+    for (unsigned row = first; row < last; row++) {
+        pa_sink_input_info **info;
+        SinkInputWidget **w;
+
+        /* The row list is rebuilt from idle, the stream may be gone */
+        if (!(info = sinkInputInfos.find(playbackRows[row])))
+            continue;
+
+        if (!(w = sinkInputWidgets.find((*info)->index))) {
+            updateSinkInputWidget(**info);
+            w = sinkInputWidgets.find((*info)->index);
+        }
+
+        playbackList->placeRow(**w, row);
+        (*w)->show();
+    }
+}
+
+void MainWindow::bindRecordingRows(unsigned first, unsigned last) {
+    std::set<uint32_t> wanted(recordingRows.begin() + first, recordingRows.begin() + last);
+
+    for (IndexMap<SourceOutputWidget*>::iterator i = sourceOutputWidgets.begin(); i != sourceOutputWidgets.end();) {
+        if (wanted.count(i->first)) {
+            ++i;
+            continue;
+        }
+
+        releaseSourceOutputWidget(i->second);
+        sourceOutputWidgets.erase((i++)->first);
+    }
+
+    for (unsigned row = first; row < last; row++) {
+        pa_source_output_info **info;
+        SourceOutputWidget **w;
+
+        /* The row list is rebuilt from idle, the stream may be gone */
+        if (!(info = sourceOutputInfos.find(recordingRows[row])))
+            continue;
+
+        if (!(w = sourceOutputWidgets.find((*info)->index))) {
+            updateSourceOutputWidget(**info);
+            w = sourceOutputWidgets.find((*info)->index);
+        }
+
+        recordingList->placeRow(**w, row);
+        (*w)->show();
+    }
+}
+
+/* Widgets that scroll out of view are kept around for the next stream that
+ * scrolls in, only the per-stream state is dropped */
+void MainWindow::releaseSinkInputWidget(SinkInputWidget *w) {
+    w->flushVolumeUpdate();
+    meterScheduler.removeMeter(w);
+    clients.detach(w->clientIndex, w);
+    w->resetMeter();
+    w->hide();
+    spareSinkInputWidgets.push_back(w);
+}
+
+void MainWindow::releaseSourceOutputWidget(SourceOutputWidget *w) {
+    w->flushVolumeUpdate();
+    meterScheduler.removeMeter(w);
+    clients.detach(w->clientIndex, w);
+    w->resetMeter();
+    w->hide();
+    spareSourceOutputWidgets.push_back(w);
+}
+
+/* Only the streams scrolled into view have a widget to relabel.
+ * setSinkIndex() and setSourceIndex() pick the label and sample spec up
+ * from the device info, or fall back to "Unknown" once the device is gone */
+void MainWindow::updateSinkStreamLabels(uint32_t sink) {
+    std::set<uint32_t> *streams;
+    SinkInputWidget **w;
+
+    if (!(streams = sinkInputsBySink.find(sink)))
+        return;
+
+    for (std::set<uint32_t>::iterator i = streams->begin(); i != streams->end(); ++i)
+        if ((w = sinkInputWidgets.find(*i)))
+            (*w)->setSinkIndex(sink);
+}
+
+void MainWindow::updateSourceStreamLabels(uint32_t source) {
+    std::set<uint32_t> *streams;
+    SourceOutputWidget **w;
+
+    if (!(streams = sourceOutputsBySource.find(source)))
+        return;
+
+    for (std::set<uint32_t>::iterator i = streams->begin(); i != streams->end(); ++i)
+        if ((w = sourceOutputWidgets.find(*i)))
+            (*w)->setSourceIndex(source);
+}
+
+void MainWindow::buildPage(int page) {
+
+    if (page < 0 || page >= N_PAGES || pageBuilt[page])
+        return;
+
+    pageBuilt[page] = true;
+
+    switch (page) {
+        case PAGE_PLAYBACK:
+        case PAGE_RECORDING:
+            /* The stream lists bind their rows once the visibility
+             * update below hands them the row count */
+            break;
+
+        case PAGE_OUTPUT_DEVICES:
+            for (IndexMap<pa_sink_info*>::iterator i = sinkInfos.begin(); i != sinkInfos.end(); ++i)
+                updateSinkWidget(*i->second);
+            break;
+
+        case PAGE_INPUT_DEVICES:
+            for (IndexMap<pa_source_info*>::iterator i = sourceInfos.begin(); i != sourceInfos.end(); ++i)
+                updateSourceWidget(*i->second);
+            break;
+
+        case PAGE_CONFIGURATION:
+            for (IndexMap<pa_card_info*>::iterator i = cardInfos.begin(); i != cardInfos.end(); ++i)
+                updateCardWidget(*i->second);
+            break;
+    }
+
+    g_debug(_("Built notebook page %d"), page);
+
+    updateDeviceVisibility();
+}
+
+/* Called once the initial lists are in. The page on screen gets its widgets
+ * right away, the others are filled in one per idle cycle */
+void MainWindow::buildPages() {
+
+    buildPage(notebook->get_current_page());
+
+    if (!buildConnection.connected())
+        buildConnection = Glib::signal_idle().connect(sigc::mem_fun(*this, &MainWindow::onBuildIdle), Glib::PRIORITY_LOW);
+}
+
+bool MainWindow::onBuildIdle() {
+
+    for (int i = 0; i < N_PAGES; i++)
+        if (!pageBuilt[i]) {
+            buildPage(i);
+            return true;
+        }
+
+    return false;
+}
+
+void MainWindow::onNotebookPageChanged() {
+
+    /* Until the initial lists are complete buildPages() takes care of it */
+    if (!m_connected)
+        return;
+
+    buildPage(notebook->get_current_page());
+}
+
 void MainWindow::setConnectingMessage(const char *string) {
     Glib::ustring markup = "<i>";
     if (!string)
@@ -1101,3 +2107,28 @@ void MainWindow::onSourceOutputTypeComboBoxChanged() {
 
     updateDeviceVisibility();
 }
+
+void MainWindow::addFilterEntry(int page, Gtk::Box *box) {
+    Gtk::Label *label = Gtk::manage(new Gtk::Label());
+
+    label->set_markup_with_mnemonic(_("<b>_Filter:</b>"));
+    label->set_mnemonic_widget(filterEntries[page]);
+
+    box->pack_start(*label, false, false, 0);
+    box->reorder_child(*label, 0);
+    box->pack_start(filterEntries[page], false, false, 0);
+    box->reorder_child(filterEntries[page], 1);
+
+    label->show();
+    filterEntries[page].show();
+
+    filterEntries[page].signal_changed().connect(sigc::bind(sigc::mem_fun(*this, &MainWindow::onFilterChanged), page));
+}
+
+void MainWindow::onFilterChanged(int page) {
+    SearchIndex::parse(filterEntries[page].get_text(), &filterTerms[page]);
+
+    /* Only the text of each object is compared, the widgets are shown
+     * and hidden by the same pass as for the type selectors */
+    updateDeviceVisibility();
+}
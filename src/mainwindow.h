@@ -21,7 +21,25 @@
 #ifndef mainwindow_h
 #define mainwindow_h
 
+#include <set>
+#include <vector>
+
 #include "pavucontrol.h"
+#include "cliplog.h"
+#include "meterscheduler.h"
+#include "monitorstreamregistry.h"
+#include "streamrestorecache.h"
+#include "indexmap.h"
+#include "clientregistry.h"
+#include "devicemenu.h"
+#include "controlsocket.h"
+#include "mixersnapshot.h"
+#include "streamselection.h"
+#include "streamrouter.h"
+#include "volumefader.h"
+#include "undohistory.h"
+#include "searchindex.h"
+#include "resamplesummary.h"
 #include <pulse/ext-stream-restore.h>
 #if HAVE_EXT_DEVICE_RESTORE_API
 #  include <pulse/ext-device-restore.h>
@@ -33,6 +51,7 @@ class SourceWidget;
 class SinkInputWidget;
 class SourceOutputWidget;
 class RoleWidget;
+class VirtualList;
 
 class MainWindow : public Gtk::Window {
 public:
@@ -47,10 +66,11 @@ public:
     void updateSourceOutput(const pa_source_output_info &info);
     void updateClient(const pa_client_info &info);
     void updateServer(const pa_server_info &info);
-    void updateVolumeMeter(uint32_t source_index, uint32_t sink_input_index, double v);
+    void updateVolumeMeter(uint32_t source_index, uint32_t sink_input_index, double v, unsigned clipped);
     void updateRole(const pa_ext_stream_restore_info &info);
 #if HAVE_EXT_DEVICE_RESTORE_API
     void updateDeviceInfo(const pa_ext_device_restore_info &info);
+    void queueFormatRead(uint32_t index);
 #endif
 
     void removeCard(uint32_t index);
@@ -62,19 +82,38 @@ public:
 
     void removeAllWidgets();
 
+    void buildPage(int page);
+    void buildPages();
+
     void setConnectingMessage(const char *string = NULL);
 
     Gtk::Notebook *notebook;
+    Gtk::ScrolledWindow *streamsScrolledWindow, *recsScrolledWindow;
     Gtk::VBox *streamsVBox, *recsVBox, *sinksVBox, *sourcesVBox, *cardsVBox;
     Gtk::Label *noStreamsLabel, *noRecsLabel, *noSinksLabel, *noSourcesLabel, *noCardsLabel, *connectingLabel;
     Gtk::ComboBox *sinkInputTypeComboBox, *sourceOutputTypeComboBox, *sinkTypeComboBox, *sourceTypeComboBox;
 
-    std::map<uint32_t, CardWidget*> cardWidgets;
-    std::map<uint32_t, SinkWidget*> sinkWidgets;
-    std::map<uint32_t, SourceWidget*> sourceWidgets;
-    std::map<uint32_t, SinkInputWidget*> sinkInputWidgets;
-    std::map<uint32_t, SourceOutputWidget*> sourceOutputWidgets;
-    std::map<uint32_t, char*> clientNames;
+    IndexMap<CardWidget*> cardWidgets;
+    IndexMap<SinkWidget*> sinkWidgets;
+    IndexMap<SourceWidget*> sourceWidgets;
+    IndexMap<SinkInputWidget*> sinkInputWidgets;
+    IndexMap<SourceOutputWidget*> sourceOutputWidgets;
+    ClientRegistry clients;
+    DeviceMenu sinkMenu, sourceMenu;
+
+    /* Everything we know about the server, whether or not the widgets for
+     * it have been built yet */
+    IndexMap<pa_card_info*> cardInfos;
+    IndexMap<pa_sink_info*> sinkInfos;
+    IndexMap<pa_source_info*> sourceInfos;
+    IndexMap<pa_sink_input_info*> sinkInputInfos;
+    IndexMap<pa_source_output_info*> sourceOutputInfos;
+
+    /* Stream indexes by the device they are connected to */
+    IndexMap<std::set<uint32_t> > sinkInputsBySink, sourceOutputsBySource;
+#if HAVE_EXT_DEVICE_RESTORE_API
+    IndexMap<std::vector<pa_encoding_t> > sinkFormats;
+#endif
 
     SinkInputType showSinkInputType;
     SinkType showSinkType;
@@ -99,7 +138,33 @@ public:
     bool createEventRoleWidget();
     void deleteEventRoleWidget();
 
-    Glib::ustring defaultSinkName, defaultSourceName;
+    void moveSinkInput(uint32_t index, uint32_t sink);
+    void moveSourceOutput(uint32_t index, uint32_t source);
+
+    /* Device names are looked up by their quark, the default devices are
+     * remembered by name until a device of that name shows up */
+    IndexMap<uint32_t> sinksByName, sourcesByName;
+    GQuark defaultSinkName, defaultSourceName;
+    uint32_t defaultSinkIndex, defaultSourceIndex;
+
+    ClipLog clipLog;
+    void saveClipLog();
+
+    void saveSnapshot();
+    void restoreSnapshot();
+    void onSnapshotRestored(unsigned operations, unsigned failed);
+
+    MonitorStreamRegistry monitorStreams;
+    StreamRestoreCache streamRestore;
+    MeterScheduler meterScheduler;
+    ControlSocket controlSocket;
+    MixerSnapshot snapshot;
+    StreamSelection playbackSelection, recordingSelection;
+    StreamRouter router;
+    VolumeFader fader;
+    UndoHistory history;
+    SearchIndex search;
+    ResampleSummary playbackResampling, recordingResampling;
 
     bool canRenameDevices;
 
@@ -110,6 +175,55 @@ protected:
 private:
     gboolean m_connected;
     gchar* m_config_filename;
+
+    bool pageBuilt[N_PAGES];
+    sigc::connection buildConnection;
+
+    void updateCardWidget(const pa_card_info &info);
+    void updateSinkWidget(const pa_sink_info &info);
+    void updateSourceWidget(const pa_source_info &info);
+    void updateSinkInputWidget(const pa_sink_input_info &info);
+    void updateSourceOutputWidget(const pa_source_output_info &info);
+
+    /* Playback and recording streams in display order, only the ones
+     * scrolled into view have a widget */
+    VirtualList *playbackList, *recordingList;
+    std::vector<uint32_t> playbackRows, recordingRows;
+    std::vector<SinkInputWidget*> spareSinkInputWidgets;
+    std::vector<SourceOutputWidget*> spareSourceOutputWidgets;
+
+    void bindPlaybackRows(unsigned first, unsigned last);
+    void bindRecordingRows(unsigned first, unsigned last);
+    void releaseSinkInputWidget(SinkInputWidget *w);
+    void releaseSourceOutputWidget(SourceOutputWidget *w);
+    void setDefaultSink(uint32_t index);
+    void setDefaultSource(uint32_t index);
+    void removeStreamFromDevice(IndexMap<std::set<uint32_t> > &byDevice, uint32_t device, uint32_t stream);
+    void routeSinkInput(const pa_sink_input_info &info);
+    void routeSourceOutput(const pa_source_output_info &info);
+
+    /* Relabel the stream widgets showing a device when it changes */
+    void updateSinkStreamLabels(uint32_t sink);
+    void updateSourceStreamLabels(uint32_t source);
+
+#if HAVE_EXT_DEVICE_RESTORE_API
+    void updateSinkFormats(SinkWidget *w);
+
+    /* Sinks whose formats are read from the next idle callback */
+    std::set<uint32_t> pendingFormatReads;
+    sigc::connection formatReadConnection;
+    bool onFormatReadIdle();
+#endif
+
+    void onNotebookPageChanged();
+    bool onBuildIdle();
+
+    /* The filter entry of each page and the terms typed into it */
+    Gtk::Entry filterEntries[N_PAGES];
+    SearchIndex::Terms filterTerms[N_PAGES];
+    void addFilterEntry(int page, Gtk::Box *box);
+    void onFilterChanged(int page);
+    bool isFiltering(int page) const { return !filterTerms[page].empty(); }
 };
 
 
@@ -0,0 +1,339 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <algorithm>
+#include <vector>
+#include <math.h>
+
+#include "meterscheduler.h"
+#include "mainwindow.h"
+#include "minimalstreamwidget.h"
+
+#include "i18n.h"
+
+/* Levels below this do not count as activity when ranking meters */
+#define METER_ACTIVITY_THRESHOLD 0.01
+
+/* Used for meter ranking */
+struct MeterRank {
+    bool visible;
+    gint64 lastActive;
+    std::pair<uint32_t, uint32_t> key;
+};
+
+struct meter_rank_compare {
+    bool operator() (const MeterRank& lhs, const MeterRank& rhs) const {
+
+        if (lhs.visible != rhs.visible)
+            return lhs.visible;
+
+        return lhs.lastActive > rhs.lastActive;
+    }
+};
+
+/*** MeterScheduler ***/
+MeterScheduler::MeterScheduler(MainWindow *mainWindow) :
+    mpMainWindow(mainWindow),
+    mBudget(METER_BUDGET_DEFAULT),
+    mStreams(0),
+    mRate(METER_RATE_DEFAULT),
+    mAdaptive(false),
+    rotateCursor(PA_INVALID_INDEX, PA_INVALID_INDEX) {
+}
+
+MeterScheduler::~MeterScheduler() {
+    idleConnection.disconnect();
+    rotateConnection.disconnect();
+
+    for (std::map<MeterKey, Meter>::iterator i = meters.begin(); i != meters.end(); ++i)
+        disconnectMeter(i->second);
+
+    /* Widgets may outlive us while the window is torn down */
+    for (std::map<MinimalStreamWidget*, MeterKey>::iterator i = widgetMeters.begin(); i != widgetMeters.end(); ++i)
+        i->first->meterScheduler = NULL;
+}
+
+void MeterScheduler::setBudget(unsigned budget) {
+    mBudget = budget;
+    queueSchedule();
+}
+
+unsigned MeterScheduler::getBudget() const {
+    return mBudget;
+}
+
+void MeterScheduler::setRate(unsigned rate, bool adaptive) {
+    std::map<MeterKey, Meter>::iterator i;
+
+    if (rate == 0 || (rate == mRate && adaptive == mAdaptive))
+        return;
+
+    mRate = rate;
+    mAdaptive = adaptive;
+
+    /* The rate is fixed when the stream is connected, so reopen them */
+    for (i = meters.begin(); i != meters.end(); ++i)
+        disconnectMeter(i->second);
+
+    mpMainWindow->monitorStreams.flush();
+
+    queueSchedule();
+}
+
+unsigned MeterScheduler::getRate() const {
+    return mRate;
+}
+
+bool MeterScheduler::isAdaptive() const {
+    return mAdaptive;
+}
+
+unsigned MeterScheduler::streamCount() const {
+    return mStreams;
+}
+
+unsigned MeterScheduler::meterCount() const {
+    return meters.size();
+}
+
+void MeterScheduler::addMeter(MinimalStreamWidget *w, uint32_t source_idx, uint32_t stream_idx, bool suspend) {
+    MeterKey key(source_idx, stream_idx);
+    std::map<MinimalStreamWidget*, MeterKey>::iterator i;
+    std::map<MeterKey, Meter>::iterator j;
+
+    if ((i = widgetMeters.find(w)) != widgetMeters.end()) {
+        if (i->second == key)
+            return;
+
+        removeMeter(w);
+    }
+
+    if ((j = meters.find(key)) == meters.end()) {
+        Meter m;
+
+        m.suspend = suspend;
+        m.stream = NULL;
+        m.lastActive = 0;
+        m.idle = false;
+        m.lastLevel = -1;
+        m.steadySince = 0;
+        j = meters.insert(std::make_pair(key, m)).first;
+    }
+
+    j->second.widgets.insert(w);
+    widgetMeters[w] = key;
+    w->meterScheduler = this;
+
+    queueSchedule();
+}
+
+void MeterScheduler::removeMeter(MinimalStreamWidget *w) {
+    std::map<MinimalStreamWidget*, MeterKey>::iterator i;
+    std::map<MeterKey, Meter>::iterator j;
+
+    if ((i = widgetMeters.find(w)) == widgetMeters.end())
+        return;
+
+    j = meters.find(i->second);
+    widgetMeters.erase(i);
+    w->meterScheduler = NULL;
+
+    if (j == meters.end())
+        return;
+
+    j->second.widgets.erase(w);
+
+    if (j->second.widgets.empty()) {
+        disconnectMeter(j->second);
+        meters.erase(j);
+        queueSchedule();
+    }
+}
+
+void MeterScheduler::noteLevel(uint32_t source_idx, uint32_t stream_idx, double v) {
+    std::map<MeterKey, Meter>::iterator i;
+    gint64 now;
+
+    if ((i = meters.find(MeterKey(source_idx, stream_idx))) == meters.end())
+        return;
+
+    Meter &m = i->second;
+    now = g_get_monotonic_time();
+
+    if (v >= METER_ACTIVITY_THRESHOLD)
+        m.lastActive = now;
+
+    if (!mAdaptive || !m.stream || v < 0)
+        return;
+
+    if (m.lastLevel < 0 || fabs(v - m.lastLevel) >= METER_STEADY_DELTA) {
+        m.steadySince = now;
+
+        if (m.idle) {
+            setMeterRate(m, mRate);
+            m.idle = false;
+        }
+    } else if (!m.idle && mRate > METER_IDLE_RATE && now - m.steadySince >= METER_STEADY_USEC) {
+        setMeterRate(m, METER_IDLE_RATE);
+        m.idle = true;
+    }
+
+    m.lastLevel = v;
+}
+
+bool MeterScheduler::isVisible(const Meter &m) const {
+
+    for (std::set<MinimalStreamWidget*>::const_iterator i = m.widgets.begin(); i != m.widgets.end(); ++i)
+        if ((*i)->get_mapped())
+            return true;
+
+    return false;
+}
+
+void MeterScheduler::connectMeter(const MeterKey &key, Meter &m) {
+    if (m.stream)
+        return;
+
+    if (!(m.stream = mpMainWindow->monitorStreams.acquire(key.first, key.second, m.suspend)))
+        return;
+
+    mStreams++;
+
+    m.idle = false;
+    m.lastLevel = -1;
+
+    /* A reused stream may have been left at the idle rate */
+    if (mAdaptive)
+        setMeterRate(m, mRate);
+}
+
+void MeterScheduler::disconnectMeter(Meter &m) {
+    if (!m.stream)
+        return;
+
+    mpMainWindow->monitorStreams.release(m.stream);
+
+    m.stream = NULL;
+    mStreams--;
+}
+
+void MeterScheduler::setMeterRate(Meter &m, unsigned rate) {
+    pa_operation *o;
+
+    if (!(o = pa_stream_update_sample_rate(m.stream, rate, NULL, NULL))) {
+        g_debug(_("Failed to change meter rate: %s"), pa_strerror(pa_context_errno(get_context())));
+        return;
+    }
+
+    pa_operation_unref(o);
+}
+
+void MeterScheduler::queueSchedule() {
+    if (idleConnection.connected())
+        return;
+
+    idleConnection = Glib::signal_idle().connect(sigc::mem_fun(*this, &MeterScheduler::onIdle));
+}
+
+bool MeterScheduler::onIdle() {
+    schedule();
+    return false;
+}
+
+bool MeterScheduler::onRotate() {
+    schedule();
+    return mBudget > 0 && meters.size() > mBudget;
+}
+
+void MeterScheduler::schedule() {
+    std::map<MeterKey, Meter>::iterator i;
+    std::set<MeterKey> granted, wanted;
+    unsigned before = mStreams, needed;
+
+    if (mBudget == 0 || meters.size() <= mBudget) {
+        for (i = meters.begin(); i != meters.end(); ++i)
+            granted.insert(i->first);
+    } else {
+        std::vector<MeterRank> ranked;
+        unsigned rotate, pinned, n, seen;
+
+        /* Keep a quarter of the budget for sampling everything that
+         * did not make it into the visible or recently active set */
+        rotate = mBudget > 1 ? std::max(1u, mBudget / 4) : 0;
+        pinned = mBudget - rotate;
+
+        for (i = meters.begin(); i != meters.end(); ++i) {
+            MeterRank r;
+
+            r.visible = isVisible(i->second);
+            r.lastActive = i->second.lastActive;
+            r.key = i->first;
+            ranked.push_back(r);
+        }
+
+        std::sort(ranked.begin(), ranked.end(), meter_rank_compare());
+
+        for (n = 0; n < pinned; n++)
+            granted.insert(ranked[n].key);
+
+        i = meters.upper_bound(rotateCursor);
+        for (n = 0, seen = 0; n < rotate && seen < meters.size(); seen++, ++i) {
+            if (i == meters.end())
+                i = meters.begin();
+
+            if (!granted.count(i->first)) {
+                granted.insert(i->first);
+                rotateCursor = i->first;
+                n++;
+            }
+        }
+
+        if (!rotateConnection.connected())
+            rotateConnection = Glib::signal_timeout().connect(sigc::mem_fun(*this, &MeterScheduler::onRotate), METER_ROTATE_INTERVAL);
+    }
+
+    for (i = meters.begin(); i != meters.end(); ++i)
+        if (!granted.count(i->first))
+            disconnectMeter(i->second);
+
+    /* Released streams stay parked on the server for a while, so those
+     * beyond what is left of the budget are closed before new ones are
+     * opened. Parked streams of the meters about to connect are reused
+     * and spared. */
+    if (mBudget > 0) {
+        for (i = meters.begin(); i != meters.end(); ++i)
+            if (granted.count(i->first) && !i->second.stream)
+                wanted.insert(i->first);
+
+        needed = mStreams + wanted.size();
+        mpMainWindow->monitorStreams.trim(mBudget > needed ? mBudget - needed : 0, wanted);
+    }
+
+    for (i = meters.begin(); i != meters.end(); ++i)
+        if (granted.count(i->first))
+            connectMeter(i->first, i->second);
+
+    if (before != mStreams)
+        g_debug(_("Meter scheduler holds %u monitor streams for %u meters (budget %u)"), mStreams, (unsigned) meters.size(), mBudget);
+}
@@ -0,0 +1,102 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+#ifndef meterscheduler_h
+#define meterscheduler_h
+
+#include <set>
+
+#include "pavucontrol.h"
+
+class MainWindow;
+class MinimalStreamWidget;
+
+/* Maximum number of monitor streams open at the same time, 0 means no limit */
+#define METER_BUDGET_DEFAULT 64
+
+/* How often we rotate the spare streams among meters over budget, in ms */
+#define METER_ROTATE_INTERVAL 1000
+
+/* Peak samples per second delivered by each monitor stream */
+#define METER_RATE_DEFAULT 25
+
+/* In adaptive mode meters that stayed steady or silent for
+ * METER_STEADY_USEC drop to METER_IDLE_RATE until the level moves by more
+ * than METER_STEADY_DELTA again */
+#define METER_IDLE_RATE 3
+#define METER_STEADY_USEC (2 * 1000 * 1000)
+#define METER_STEADY_DELTA 0.02
+
+class MeterScheduler {
+public:
+    MeterScheduler(MainWindow *mainWindow);
+    ~MeterScheduler();
+
+    void setBudget(unsigned budget);
+    unsigned getBudget() const;
+    void setRate(unsigned rate, bool adaptive);
+    unsigned getRate() const;
+    bool isAdaptive() const;
+
+    void addMeter(MinimalStreamWidget *w, uint32_t source_idx, uint32_t stream_idx, bool suspend);
+    void removeMeter(MinimalStreamWidget *w);
+    void noteLevel(uint32_t source_idx, uint32_t stream_idx, double v);
+
+    unsigned streamCount() const;
+    unsigned meterCount() const;
+
+private:
+    typedef std::pair<uint32_t, uint32_t> MeterKey;
+
+    struct Meter {
+        bool suspend;
+        std::set<MinimalStreamWidget*> widgets;
+        pa_stream *stream;
+        gint64 lastActive;
+
+        /* Adaptive rate state */
+        bool idle;
+        double lastLevel;
+        gint64 steadySince;
+    };
+
+    MainWindow *mpMainWindow;
+    unsigned mBudget;
+    unsigned mStreams;
+    unsigned mRate;
+    bool mAdaptive;
+
+    std::map<MeterKey, Meter> meters;
+    std::map<MinimalStreamWidget*, MeterKey> widgetMeters;
+    MeterKey rotateCursor;
+
+    sigc::connection idleConnection, rotateConnection;
+
+    void queueSchedule();
+    void schedule();
+    bool onIdle();
+    bool onRotate();
+    bool isVisible(const Meter &m) const;
+    void connectMeter(const MeterKey &key, Meter &m);
+    void disconnectMeter(Meter &m);
+    void setMeterRate(Meter &m, unsigned rate);
+};
+
+#endif
@@ -23,14 +23,20 @@
 #endif
 
 #include "minimalstreamwidget.h"
+#include "meterscheduler.h"
+
+#include "i18n.h"
 
 /*** MinimalStreamWidget ***/
 MinimalStreamWidget::MinimalStreamWidget(BaseObjectType* cobject, const Glib::RefPtr<Gtk::Builder>& x) :
     Gtk::VBox(cobject),
     peakProgressBar(),
     lastPeak(0),
+    clipCount(0),
+    clipEvent(0),
     updating(false),
-    volumeMeterEnabled(false) {
+    volumeMeterEnabled(false),
+    meterScheduler(NULL) {
 
     x->get_widget("channelsVBox", channelsVBox);
     x->get_widget("nameLabel", nameLabel);
@@ -38,9 +44,27 @@ MinimalStreamWidget::MinimalStreamWidget(BaseObjectType* cobject, const Glib::Re
     x->get_widget("iconImage", iconImage);
 
     peakProgressBar.set_size_request(-1, 10);
-    channelsVBox->pack_end(peakProgressBar, false, false);
+    peakProgressBar.set_has_tooltip(true);
+    peakProgressBar.signal_query_tooltip().connect(sigc::mem_fun(*this, &MinimalStreamWidget::onMeterQueryTooltip));
+    meterHBox.set_spacing(6);
+    meterHBox.pack_start(peakProgressBar, true, true);
+
+    clipEventBox.add(clipLabel);
+    clipEventBox.signal_button_press_event().connect(sigc::mem_fun(*this, &MinimalStreamWidget::onClipButtonPress));
+    meterHBox.pack_start(clipEventBox, false, false);
+    resetClip();
 
-    peakProgressBar.hide();
+    channelsVBox->pack_end(meterHBox, false, false);
+
+    peakProgressBar.show();
+    clipEventBox.show_all();
+    meterHBox.hide();
+}
+
+MinimalStreamWidget::~MinimalStreamWidget() {
+    /* Our monitor stream must not outlive us */
+    if (meterScheduler)
+        meterScheduler->removeMeter(this);
 }
 
 #define DECAY_STEP .04
@@ -69,6 +93,59 @@ void MinimalStreamWidget::enableVolumeMeter() {
         return;
 
     volumeMeterEnabled = true;
-    peakProgressBar.show();
+    meterHBox.show();
+}
+
+void MinimalStreamWidget::updateClip(unsigned readings) {
+    char txt[128];
+
+    if (clipCount == 0)
+        clipLabel.set_markup("<small><span background=\"red\" foreground=\"white\"><b> CLIP </b></span></small>");
+
+    clipCount += readings;
+
+    snprintf(txt, sizeof(txt), _("%lu clipped meter readings since last reset. Click to reset."), clipCount);
+    clipEventBox.set_tooltip_text(txt);
+}
+
+void MinimalStreamWidget::resetClip() {
+    clipCount = 0;
+    clipLabel.set_markup("<small><span foreground=\"gray\"> CLIP </span></small>");
+    clipEventBox.set_tooltip_text(_("No clipping detected"));
+}
+
+void MinimalStreamWidget::resetMeter() {
+    lastPeak = 0;
+    peakProgressBar.set_fraction(0);
+    resetClip();
+    clipEvent = 0;
+}
+
+/* Tells why a meter may be frozen when there are more of them than
+ * monitor streams allowed */
+bool MinimalStreamWidget::onMeterQueryTooltip(int, int, bool, const Glib::RefPtr<Gtk::Tooltip>& tooltip) {
+    char txt[128];
+
+    if (!meterScheduler)
+        return false;
+
+    if (meterScheduler->getBudget() > 0 && meterScheduler->meterCount() > meterScheduler->getBudget())
+        snprintf(txt, sizeof(txt), _("%u of %u level meters are live, at most %u at a time."),
+                 meterScheduler->streamCount(), meterScheduler->meterCount(), meterScheduler->getBudget());
+    else
+        snprintf(txt, sizeof(txt), _("%u of %u level meters are live."),
+                 meterScheduler->streamCount(), meterScheduler->meterCount());
+
+    tooltip->set_text(txt);
+    return true;
+}
+
+bool MinimalStreamWidget::onClipButtonPress(GdkEventButton* event) {
+    if (GDK_BUTTON_PRESS == event->type && 1 == event->button) {
+        resetClip();
+        return true;
+    }
+
+    return false;
 }
 
@@ -23,24 +23,41 @@
 
 #include "pavucontrol.h"
 
+class MeterScheduler;
+
 class MinimalStreamWidget : public Gtk::VBox {
 public:
     MinimalStreamWidget(BaseObjectType* cobject, const Glib::RefPtr<Gtk::Builder>& x);
+    virtual ~MinimalStreamWidget();
 
     Gtk::VBox *channelsVBox;
     Gtk::Label *nameLabel, *boldNameLabel;
     Gtk::Image *iconImage;
+    Gtk::HBox meterHBox;
     Gtk::ProgressBar peakProgressBar;
+    Gtk::EventBox clipEventBox;
+    Gtk::Label clipLabel;
     double lastPeak;
 
+    unsigned long clipCount;
+    guint64 clipEvent;
+
     bool updating;
 
     virtual void onMuteToggleButton() = 0;
     virtual void updateChannelVolume(int channel, pa_volume_t v) = 0;
 
     bool volumeMeterEnabled;
+    MeterScheduler *meterScheduler;
     void enableVolumeMeter();
     void updatePeak(double v);
+    void updateClip(unsigned readings);
+    void resetClip();
+    void resetMeter();
+
+protected:
+    virtual bool onClipButtonPress(GdkEventButton*);
+    virtual bool onMeterQueryTooltip(int x, int y, bool keyboard, const Glib::RefPtr<Gtk::Tooltip>& tooltip);
 };
 
 #endif
@@ -0,0 +1,468 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+
+#include <string.h>
+
+#include <map>
+#include <set>
+
+#include "mixersnapshot.h"
+#include "mainwindow.h"
+#include "jsonvalue.h"
+#include "jsonwriter.h"
+#include "operationbatch.h"
+
+#define SNAPSHOT_VERSION 1
+
+/* module-stream-restore prefers the role, then the application */
+static std::string stream_key(pa_proplist *p) {
+    const char *s;
+
+    if ((s = pa_proplist_gets(p, PA_PROP_MEDIA_ROLE)))
+        return std::string("role:") + s;
+    if ((s = pa_proplist_gets(p, PA_PROP_APPLICATION_ID)))
+        return std::string("application-id:") + s;
+    if ((s = pa_proplist_gets(p, PA_PROP_APPLICATION_NAME)))
+        return std::string("application-name:") + s;
+
+    return std::string();
+}
+
+static void write_volume(JsonWriter &json, const pa_cvolume &v, bool mute) {
+    json.key("volume");
+    json.beginArray();
+    for (uint8_t i = 0; i < v.channels; i++)
+        json.number((long long) v.values[i]);
+    json.endArray();
+    json.member("mute", mute);
+}
+
+static bool read_volume(const JsonValue *v, pa_cvolume *volume) {
+    if (!v || !v->isArray() || v->size() == 0 || v->size() > PA_CHANNELS_MAX)
+        return false;
+
+    volume->channels = v->size();
+    for (uint8_t i = 0; i < volume->channels; i++) {
+        const JsonValue *n = v->at(i);
+
+        if (!n->isNumber() || n->asNumber() < 0 || n->asNumber() > PA_VOLUME_MAX)
+            return false;
+
+        volume->values[i] = (pa_volume_t) n->asNumber();
+    }
+
+    return true;
+}
+
+/* The saved volume, spread over the channels the object has now */
+static bool volume_for(const JsonValue &entry, uint8_t channels, pa_cvolume *volume) {
+    pa_cvolume saved;
+
+    if (!read_volume(entry.get("volume"), &saved))
+        return false;
+
+    if (channels == 0 || saved.channels == channels)
+        *volume = saved;
+    else
+        pa_cvolume_set(volume, channels, pa_cvolume_max(&saved));
+
+    return true;
+}
+
+static const char* string_member(const JsonValue &entry, const char *key) {
+    const JsonValue *v = entry.get(key);
+
+    return v && v->isString() ? v->asString().c_str() : NULL;
+}
+
+/* Mute that differs from the current state, or -1 */
+static int mute_for(const JsonValue &entry, int current) {
+    const JsonValue *v = entry.get("mute");
+
+    if (!v || !v->isBoolean() || (int) v->asBoolean() == current)
+        return -1;
+
+    return v->asBoolean();
+}
+
+/*** MixerSnapshot ***/
+MixerSnapshot::MixerSnapshot(MainWindow *w) :
+    mpMainWindow(w) {
+}
+
+std::string MixerSnapshot::capture() {
+    MainWindow *w = mpMainWindow;
+    JsonWriter json;
+    std::set<std::string> seen;
+    const char *name;
+
+    json.beginObject();
+    json.key("version");
+    json.number((long long) SNAPSHOT_VERSION);
+
+    name = w->defaultSinkName ? g_quark_to_string(w->defaultSinkName) : NULL;
+    json.member("default_sink", name && *name ? name : NULL);
+    name = w->defaultSourceName ? g_quark_to_string(w->defaultSourceName) : NULL;
+    json.member("default_source", name && *name ? name : NULL);
+
+    json.key("cards");
+    json.beginArray();
+    for (IndexMap<pa_card_info*>::iterator i = w->cardInfos.begin(); i != w->cardInfos.end(); ++i) {
+        const pa_card_info *card = i->second;
+
+        json.beginObject();
+        json.member("name", card->name);
+        json.member("profile", card->active_profile ? card->active_profile->name : NULL);
+        json.key("latency_offsets");
+        json.beginObject();
+        for (uint32_t j = 0; j < card->n_ports; j++) {
+            json.key(card->ports[j]->name);
+            json.number((long long) card->ports[j]->latency_offset);
+        }
+        json.endObject();
+        json.endObject();
+    }
+    json.endArray();
+
+    json.key("sinks");
+    json.beginArray();
+    for (IndexMap<pa_sink_info*>::iterator i = w->sinkInfos.begin(); i != w->sinkInfos.end(); ++i) {
+        json.beginObject();
+        json.member("name", i->second->name);
+        json.member("port", i->second->active_port ? i->second->active_port->name : NULL);
+        write_volume(json, i->second->volume, i->second->mute);
+        json.endObject();
+    }
+    json.endArray();
+
+    json.key("sources");
+    json.beginArray();
+    for (IndexMap<pa_source_info*>::iterator i = w->sourceInfos.begin(); i != w->sourceInfos.end(); ++i) {
+        json.beginObject();
+        json.member("name", i->second->name);
+        json.member("port", i->second->active_port ? i->second->active_port->name : NULL);
+        write_volume(json, i->second->volume, i->second->mute);
+        json.endObject();
+    }
+    json.endArray();
+
+    /* Streams of the same kind share one entry, the first one wins */
+    json.key("sink_inputs");
+    json.beginArray();
+    for (IndexMap<pa_sink_input_info*>::iterator i = w->sinkInputInfos.begin(); i != w->sinkInputInfos.end(); ++i) {
+        std::string key = stream_key(i->second->proplist);
+        pa_sink_info **sink = w->sinkInfos.find(i->second->sink);
+
+        if (key.empty() || !seen.insert(key).second)
+            continue;
+
+        json.beginObject();
+        json.member("key", key.c_str());
+        json.member("device", sink ? (*sink)->name : NULL);
+        write_volume(json, i->second->volume, i->second->mute);
+        json.endObject();
+    }
+    json.endArray();
+
+    seen.clear();
+
+    json.key("source_outputs");
+    json.beginArray();
+    for (IndexMap<pa_source_output_info*>::iterator i = w->sourceOutputInfos.begin(); i != w->sourceOutputInfos.end(); ++i) {
+        std::string key = stream_key(i->second->proplist);
+        pa_source_info **source = w->sourceInfos.find(i->second->source);
+
+        if (key.empty() || !seen.insert(key).second)
+            continue;
+
+        json.beginObject();
+        json.member("key", key.c_str());
+        json.member("device", source ? (*source)->name : NULL);
+#if HAVE_SOURCE_OUTPUT_VOLUMES
+        write_volume(json, i->second->volume, i->second->mute);
+#endif
+        json.endObject();
+    }
+    json.endArray();
+
+    json.endObject();
+    json.endLine();
+
+    return json.buffer();
+}
+
+void MixerSnapshot::onRestored(OperationBatch *b, const sigc::slot<void, unsigned, unsigned> &done) {
+    restores.erase(b);
+    done(b->operations(), b->failed());
+}
+
+void MixerSnapshot::cancel() {
+    for (std::set<OperationBatch*>::iterator i = restores.begin(); i != restores.end(); ++i)
+        delete *i;
+
+    restores.clear();
+}
+
+bool MixerSnapshot::restore(const std::string &data, const sigc::slot<void, unsigned, unsigned> &done, std::string *error) {
+    pa_context *c = get_context();
+    const JsonValue *version;
+    const char *name;
+    JsonValue *root;
+    OperationBatch *b;
+
+    if (!c || pa_context_get_state(c) != PA_CONTEXT_READY) {
+        *error = "Not connected to the sound server";
+        return false;
+    }
+
+    if (!(root = JsonValue::parse(data, error)))
+        return false;
+
+    if (!root->isObject() || !(version = root->get("version")) || !version->isNumber() || version->asNumber() != SNAPSHOT_VERSION) {
+        *error = "Not a mixer snapshot";
+        delete root;
+        return false;
+    }
+
+    b = new OperationBatch(sigc::bind(sigc::mem_fun(*this, &MixerSnapshot::onRestored), done));
+    restores.insert(b);
+
+    /* The server works through the commands in order, so the profiles
+     * are switched before the devices they create are looked at */
+    restoreCards(b, root->get("cards"));
+    restoreSinks(b, root->get("sinks"));
+    restoreSources(b, root->get("sources"));
+
+    if ((name = string_member(*root, "default_sink")) && (!mpMainWindow->defaultSinkName || strcmp(name, g_quark_to_string(mpMainWindow->defaultSinkName)) != 0))
+        b->issue(pa_context_set_default_sink(c, name, OperationBatch::success_cb, b->next()));
+    if ((name = string_member(*root, "default_source")) && (!mpMainWindow->defaultSourceName || strcmp(name, g_quark_to_string(mpMainWindow->defaultSourceName)) != 0))
+        b->issue(pa_context_set_default_source(c, name, OperationBatch::success_cb, b->next()));
+
+    restoreSinkInputs(b, root->get("sink_inputs"));
+    restoreSourceOutputs(b, root->get("source_outputs"));
+
+    delete root;
+
+    b->end();
+
+    return true;
+}
+
+void MixerSnapshot::restoreCards(OperationBatch *b, const JsonValue *cards) {
+    pa_context *c = get_context();
+
+    if (!cards || !cards->isArray())
+        return;
+
+    for (size_t i = 0; i < cards->size(); i++) {
+        const JsonValue &entry = *cards->at(i);
+        const JsonValue *offsets;
+        const pa_card_info *card = NULL;
+        const char *name, *profile;
+
+        if (!entry.isObject() || !(name = string_member(entry, "name")))
+            continue;
+
+        /* Cards come and go with the hardware, a missing one is no error */
+        for (IndexMap<pa_card_info*>::iterator j = mpMainWindow->cardInfos.begin(); j != mpMainWindow->cardInfos.end(); ++j)
+            if (strcmp(j->second->name, name) == 0) {
+                card = j->second;
+                break;
+            }
+
+        if (!card)
+            continue;
+
+        if ((profile = string_member(entry, "profile")) && (!card->active_profile || strcmp(card->active_profile->name, profile) != 0))
+            b->issue(pa_context_set_card_profile_by_name(c, name, profile, OperationBatch::success_cb, b->next()));
+
+        if (!(offsets = entry.get("latency_offsets")) || !offsets->isObject())
+            continue;
+
+        for (uint32_t j = 0; j < card->n_ports; j++) {
+            const JsonValue *offset = offsets->get(card->ports[j]->name);
+
+            if (!offset || !offset->isNumber() || (int64_t) offset->asNumber() == card->ports[j]->latency_offset)
+                continue;
+
+            b->issue(pa_context_set_port_latency_offset(c, name, card->ports[j]->name, (int64_t) offset->asNumber(), OperationBatch::success_cb, b->next()));
+        }
+    }
+}
+
+void MixerSnapshot::restoreSinks(OperationBatch *b, const JsonValue *sinks) {
+    pa_context *c = get_context();
+
+    if (!sinks || !sinks->isArray())
+        return;
+
+    for (size_t i = 0; i < sinks->size(); i++) {
+        const JsonValue &entry = *sinks->at(i);
+        const pa_sink_info *sink = NULL;
+        pa_sink_info **info;
+        const char *name, *port;
+        GQuark q;
+        uint32_t *idx;
+        pa_cvolume volume;
+        int mute;
+
+        if (!entry.isObject() || !(name = string_member(entry, "name")))
+            continue;
+
+        /* A sink we do not know yet may come with a new card profile */
+        if ((q = g_quark_try_string(name)) && (idx = mpMainWindow->sinksByName.find(q)) && (info = mpMainWindow->sinkInfos.find(*idx)))
+            sink = *info;
+
+        /* A running fade would overwrite the restored volume */
+        if (sink)
+            mpMainWindow->fader.cancel(VolumeFader::SINK, sink->index);
+
+        if ((port = string_member(entry, "port")) && (!sink || !sink->active_port || strcmp(sink->active_port->name, port) != 0))
+            b->issue(pa_context_set_sink_port_by_name(c, name, port, OperationBatch::success_cb, b->next()));
+
+        if (volume_for(entry, sink ? sink->volume.channels : 0, &volume) && (!sink || !pa_cvolume_equal(&volume, &sink->volume)))
+            b->issue(pa_context_set_sink_volume_by_name(c, name, &volume, OperationBatch::success_cb, b->next()));
+
+        if ((mute = mute_for(entry, sink ? sink->mute : -1)) >= 0)
+            b->issue(pa_context_set_sink_mute_by_name(c, name, mute, OperationBatch::success_cb, b->next()));
+    }
+}
+
+void MixerSnapshot::restoreSources(OperationBatch *b, const JsonValue *sources) {
+    pa_context *c = get_context();
+
+    if (!sources || !sources->isArray())
+        return;
+
+    for (size_t i = 0; i < sources->size(); i++) {
+        const JsonValue &entry = *sources->at(i);
+        const pa_source_info *source = NULL;
+        pa_source_info **info;
+        const char *name, *port;
+        GQuark q;
+        uint32_t *idx;
+        pa_cvolume volume;
+        int mute;
+
+        if (!entry.isObject() || !(name = string_member(entry, "name")))
+            continue;
+
+        if ((q = g_quark_try_string(name)) && (idx = mpMainWindow->sourcesByName.find(q)) && (info = mpMainWindow->sourceInfos.find(*idx)))
+            source = *info;
+
+        if (source)
+            mpMainWindow->fader.cancel(VolumeFader::SOURCE, source->index);
+
+        if ((port = string_member(entry, "port")) && (!source || !source->active_port || strcmp(source->active_port->name, port) != 0))
+            b->issue(pa_context_set_source_port_by_name(c, name, port, OperationBatch::success_cb, b->next()));
+
+        if (volume_for(entry, source ? source->volume.channels : 0, &volume) && (!source || !pa_cvolume_equal(&volume, &source->volume)))
+            b->issue(pa_context_set_source_volume_by_name(c, name, &volume, OperationBatch::success_cb, b->next()));
+
+        if ((mute = mute_for(entry, source ? source->mute : -1)) >= 0)
+            b->issue(pa_context_set_source_mute_by_name(c, name, mute, OperationBatch::success_cb, b->next()));
+    }
+}
+
+void MixerSnapshot::restoreSinkInputs(OperationBatch *b, const JsonValue *streams) {
+    pa_context *c = get_context();
+    std::map<std::string, const JsonValue*> entries;
+
+    if (!streams || !streams->isArray())
+        return;
+
+    for (size_t i = 0; i < streams->size(); i++) {
+        const JsonValue &entry = *streams->at(i);
+        const char *key;
+
+        if (entry.isObject() && (key = string_member(entry, "key")))
+            entries.insert(std::make_pair(std::string(key), &entry));
+    }
+
+    for (IndexMap<pa_sink_input_info*>::iterator i = mpMainWindow->sinkInputInfos.begin(); i != mpMainWindow->sinkInputInfos.end(); ++i) {
+        const pa_sink_input_info *stream = i->second;
+        std::map<std::string, const JsonValue*>::iterator e = entries.find(stream_key(stream->proplist));
+        pa_sink_info **sink = mpMainWindow->sinkInfos.find(stream->sink);
+        const char *device;
+        pa_cvolume volume;
+        int mute;
+
+        if (e == entries.end())
+            continue;
+
+        mpMainWindow->fader.cancel(VolumeFader::SINK_INPUT, stream->index);
+
+        if ((device = string_member(*e->second, "device")) && (!sink || strcmp((*sink)->name, device) != 0))
+            b->issue(pa_context_move_sink_input_by_name(c, stream->index, device, OperationBatch::success_cb, b->next()));
+
+        if (volume_for(*e->second, stream->volume.channels, &volume) && !pa_cvolume_equal(&volume, &stream->volume))
+            b->issue(pa_context_set_sink_input_volume(c, stream->index, &volume, OperationBatch::success_cb, b->next()));
+
+        if ((mute = mute_for(*e->second, stream->mute)) >= 0)
+            b->issue(pa_context_set_sink_input_mute(c, stream->index, mute, OperationBatch::success_cb, b->next()));
+    }
+}
+
+void MixerSnapshot::restoreSourceOutputs(OperationBatch *b, const JsonValue *streams) {
+    pa_context *c = get_context();
+    std::map<std::string, const JsonValue*> entries;
+
+    if (!streams || !streams->isArray())
+        return;
+
+    for (size_t i = 0; i < streams->size(); i++) {
+        const JsonValue &entry = *streams->at(i);
+        const char *key;
+
+        if (entry.isObject() && (key = string_member(entry, "key")))
+            entries.insert(std::make_pair(std::string(key), &entry));
+    }
+
+    for (IndexMap<pa_source_output_info*>::iterator i = mpMainWindow->sourceOutputInfos.begin(); i != mpMainWindow->sourceOutputInfos.end(); ++i) {
+        const pa_source_output_info *stream = i->second;
+        std::map<std::string, const JsonValue*>::iterator e = entries.find(stream_key(stream->proplist));
+        pa_source_info **source = mpMainWindow->sourceInfos.find(stream->source);
+        const char *device;
+
+        if (e == entries.end())
+            continue;
+
+        if ((device = string_member(*e->second, "device")) && (!source || strcmp((*source)->name, device) != 0))
+            b->issue(pa_context_move_source_output_by_name(c, stream->index, device, OperationBatch::success_cb, b->next()));
+
+#if HAVE_SOURCE_OUTPUT_VOLUMES
+        pa_cvolume volume;
+        int mute;
+
+        mpMainWindow->fader.cancel(VolumeFader::SOURCE_OUTPUT, stream->index);
+
+        if (volume_for(*e->second, stream->volume.channels, &volume) && !pa_cvolume_equal(&volume, &stream->volume))
+            b->issue(pa_context_set_source_output_volume(c, stream->index, &volume, OperationBatch::success_cb, b->next()));
+
+        if ((mute = mute_for(*e->second, stream->mute)) >= 0)
+            b->issue(pa_context_set_source_output_mute(c, stream->index, mute, OperationBatch::success_cb, b->next()));
+#endif
+    }
+}
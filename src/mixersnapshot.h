@@ -0,0 +1,66 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+
+#ifndef mixersnapshot_h
+#define mixersnapshot_h
+
+#include <set>
+#include <string>
+
+#include "pavucontrol.h"
+
+class MainWindow;
+class JsonValue;
+class OperationBatch;
+
+/* Saves the state of devices, cards and streams as one line of JSON and
+ * brings the server back to it. Devices and cards are remembered by name,
+ * streams the way module-stream-restore tells them apart. */
+class MixerSnapshot {
+public:
+    MixerSnapshot(MainWindow *w);
+
+    std::string capture();
+
+    /* Issues every operation needed in one go, by name so that devices
+     * recreated by a profile change are found. done gets the number of
+     * operations and how many of them failed once the server has
+     * completed all of them, possibly before restore() returns. */
+    bool restore(const std::string &data, const sigc::slot<void, unsigned, unsigned> &done, std::string *error);
+
+    /* Forgets the restores still in progress without calling done, the
+     * server will not answer them on a lost connection */
+    void cancel();
+
+private:
+    MainWindow *mpMainWindow;
+    std::set<OperationBatch*> restores;
+
+    void restoreCards(OperationBatch *b, const JsonValue *cards);
+    void restoreSinks(OperationBatch *b, const JsonValue *sinks);
+    void restoreSources(OperationBatch *b, const JsonValue *sources);
+    void restoreSinkInputs(OperationBatch *b, const JsonValue *streams);
+    void restoreSourceOutputs(OperationBatch *b, const JsonValue *streams);
+
+    void onRestored(OperationBatch *b, const sigc::slot<void, unsigned, unsigned> &done);
+};
+
+#endif
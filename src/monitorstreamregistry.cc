@@ -0,0 +1,236 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <algorithm>
+#include <vector>
+
+#include "monitorstreamregistry.h"
+#include "mainwindow.h"
+
+#include "i18n.h"
+
+static bool stream_is_usable(pa_stream *s) {
+    return pa_context_get_state(pa_stream_get_context(s)) == PA_CONTEXT_READY &&
+        pa_stream_get_state(s) == PA_STREAM_READY;
+}
+
+static void cork_stream(pa_stream *s, bool cork) {
+    pa_operation *o;
+
+    if ((o = pa_stream_cork(s, cork, NULL, NULL)))
+        pa_operation_unref(o);
+}
+
+/*** MonitorStreamRegistry ***/
+MonitorStreamRegistry::MonitorStreamRegistry(MainWindow *mainWindow) :
+    mpMainWindow(mainWindow),
+    mCreated(0),
+    mReused(0) {
+}
+
+MonitorStreamRegistry::~MonitorStreamRegistry() {
+    reapConnection.disconnect();
+
+    while (!entries.empty())
+        destroy(entries.begin()->first);
+}
+
+pa_stream* MonitorStreamRegistry::acquire(uint32_t source_idx, uint32_t stream_idx, bool suspend) {
+    StreamKey key(source_idx, stream_idx);
+    std::map<StreamKey, pa_stream*>::iterator i;
+    pa_stream *s;
+
+    if ((i = parked.find(key)) != parked.end()) {
+        s = i->second;
+        parked.erase(i);
+
+        if (stream_is_usable(s)) {
+            Entry &e = entries[s];
+
+            cork_stream(s, false);
+            e.inUse = true;
+            mReused++;
+            logCounts();
+            return s;
+        }
+
+        destroy(s);
+    }
+
+    if (!(s = mpMainWindow->createMonitorStreamForSource(source_idx, stream_idx, suspend)))
+        return NULL;
+
+    pa_stream_set_state_callback(s, stream_state_cb, this);
+
+    Entry e;
+    e.key = key;
+    e.inUse = true;
+    e.failed = false;
+    e.releasedAt = 0;
+    entries[s] = e;
+
+    mCreated++;
+    logCounts();
+
+    return s;
+}
+
+void MonitorStreamRegistry::release(pa_stream *s) {
+    std::map<pa_stream*, Entry>::iterator i;
+    std::map<StreamKey, pa_stream*>::iterator j;
+
+    if ((i = entries.find(s)) == entries.end())
+        return;
+
+    Entry &e = i->second;
+
+    if (e.failed || !stream_is_usable(s)) {
+        destroy(s);
+        return;
+    }
+
+    /* Only one spare stream per object */
+    if ((j = parked.find(e.key)) != parked.end())
+        destroy(j->second);
+
+    cork_stream(s, true);
+    e.inUse = false;
+    e.releasedAt = g_get_monotonic_time();
+    parked[e.key] = s;
+
+    if (!reapConnection.connected())
+        reapConnection = Glib::signal_timeout().connect(sigc::mem_fun(*this, &MonitorStreamRegistry::onReap), MONITOR_STREAM_REAP_INTERVAL);
+}
+
+void MonitorStreamRegistry::flush() {
+    while (!parked.empty())
+        destroy(parked.begin()->second);
+}
+
+void MonitorStreamRegistry::trim(unsigned max, const std::set<StreamKey> &keep) {
+    std::vector<std::pair<gint64, pa_stream*> > spare;
+
+    for (std::map<StreamKey, pa_stream*>::iterator i = parked.begin(); i != parked.end(); ++i)
+        if (!keep.count(i->first))
+            spare.push_back(std::make_pair(entries[i->second].releasedAt, i->second));
+
+    if (spare.size() <= max)
+        return;
+
+    std::sort(spare.begin(), spare.end());
+
+    for (size_t n = 0; n < spare.size() - max; n++)
+        destroy(spare[n].second);
+}
+
+void MonitorStreamRegistry::destroy(pa_stream *s) {
+    std::map<pa_stream*, Entry>::iterator i;
+
+    if ((i = entries.find(s)) == entries.end())
+        return;
+
+    if (!i->second.inUse)
+        parked.erase(i->second.key);
+    entries.erase(i);
+
+    pa_stream_set_state_callback(s, NULL, NULL);
+    pa_stream_set_read_callback(s, NULL, NULL);
+    pa_stream_set_suspended_callback(s, NULL, NULL);
+
+    if (pa_context_get_state(pa_stream_get_context(s)) == PA_CONTEXT_READY &&
+        (pa_stream_get_state(s) == PA_STREAM_READY || pa_stream_get_state(s) == PA_STREAM_CREATING))
+        pa_stream_disconnect(s);
+
+    pa_stream_unref(s);
+
+    logCounts();
+}
+
+void MonitorStreamRegistry::stream_state_cb(pa_stream *s, void *userdata) {
+    static_cast<MonitorStreamRegistry*>(userdata)->onStateChange(s);
+}
+
+void MonitorStreamRegistry::onStateChange(pa_stream *s) {
+    std::map<pa_stream*, Entry>::iterator i;
+
+    switch (pa_stream_get_state(s)) {
+        case PA_STREAM_FAILED:
+        case PA_STREAM_TERMINATED:
+            if ((i = entries.find(s)) == entries.end())
+                return;
+
+            /* Whoever holds it will hand it back, until then we only
+             * remember that it is gone */
+            if (i->second.inUse)
+                i->second.failed = true;
+            else
+                destroy(s);
+            break;
+
+        default:
+            break;
+    }
+}
+
+bool MonitorStreamRegistry::onReap() {
+    gint64 now = g_get_monotonic_time();
+    std::map<StreamKey, pa_stream*>::iterator i, next;
+
+    for (i = parked.begin(); i != parked.end(); i = next) {
+        next = i;
+        ++next;
+
+        if (now - entries[i->second].releasedAt >= MONITOR_STREAM_GRACE_USEC)
+            destroy(i->second);
+    }
+
+    return !parked.empty();
+}
+
+unsigned MonitorStreamRegistry::liveCount() const {
+    unsigned n = 0;
+
+    for (std::map<pa_stream*, Entry>::const_iterator i = entries.begin(); i != entries.end(); ++i)
+        if (!i->second.failed)
+            n++;
+
+    return n;
+}
+
+unsigned MonitorStreamRegistry::parkedCount() const {
+    return parked.size();
+}
+
+unsigned long MonitorStreamRegistry::createdCount() const {
+    return mCreated;
+}
+
+unsigned long MonitorStreamRegistry::reusedCount() const {
+    return mReused;
+}
+
+void MonitorStreamRegistry::logCounts() const {
+    g_debug(_("Monitor streams: %u live, %u parked, %lu created, %lu reused"),
+            liveCount(), parkedCount(), mCreated, mReused);
+}
@@ -0,0 +1,78 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+#ifndef monitorstreamregistry_h
+#define monitorstreamregistry_h
+
+#include <set>
+
+#include "pavucontrol.h"
+
+class MainWindow;
+
+/* Released streams stay corked this long in case the same object comes
+ * back, before they are disconnected for good */
+#define MONITOR_STREAM_GRACE_USEC (5 * 1000 * 1000)
+#define MONITOR_STREAM_REAP_INTERVAL 1000
+
+class MonitorStreamRegistry {
+public:
+    typedef std::pair<uint32_t, uint32_t> StreamKey;
+
+    MonitorStreamRegistry(MainWindow *mainWindow);
+    ~MonitorStreamRegistry();
+
+    pa_stream* acquire(uint32_t source_idx, uint32_t stream_idx, bool suspend);
+    void release(pa_stream *s);
+    void flush();
+
+    /* Parked streams still take up a stream on the server. Disconnects
+     * the ones parked longest until at most max are left, not counting
+     * those about to be acquired again. */
+    void trim(unsigned max, const std::set<StreamKey> &keep);
+
+    unsigned liveCount() const;
+    unsigned parkedCount() const;
+    unsigned long createdCount() const;
+    unsigned long reusedCount() const;
+
+private:
+    struct Entry {
+        StreamKey key;
+        bool inUse;
+        bool failed;
+        gint64 releasedAt;
+    };
+
+    MainWindow *mpMainWindow;
+    std::map<pa_stream*, Entry> entries;
+    std::map<StreamKey, pa_stream*> parked;
+    unsigned long mCreated, mReused;
+
+    sigc::connection reapConnection;
+
+    static void stream_state_cb(pa_stream *s, void *userdata);
+    void onStateChange(pa_stream *s);
+    bool onReap();
+    void destroy(pa_stream *s);
+    void logCounts() const;
+};
+
+#endif
@@ -0,0 +1,103 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+
+#include "operationbatch.h"
+
+/*** OperationBatch ***/
+OperationBatch::OperationBatch(const sigc::slot<void, OperationBatch*> &done) :
+    mDone(done),
+    mNext(NULL),
+    mOperations(0),
+    mFailed(0),
+    mEnded(false) {
+}
+
+OperationBatch::~OperationBatch() {
+    for (std::set<Operation*>::iterator i = mPending.begin(); i != mPending.end(); ++i)
+        delete *i;
+
+    delete mNext;
+}
+
+void* OperationBatch::next(const std::string &label) {
+    g_assert(!mNext);
+
+    mNext = new Operation;
+    mNext->batch = this;
+    mNext->label = label;
+
+    return mNext;
+}
+
+void OperationBatch::issue(pa_operation *o) {
+    Operation *op = mNext;
+
+    mNext = NULL;
+    mOperations++;
+
+    /* Also the case where the caller gave up before asking for userdata */
+    if (!o) {
+        fail(op, pa_strerror(pa_context_errno(get_context())));
+        delete op;
+        return;
+    }
+
+    g_assert(op);
+    mPending.insert(op);
+    pa_operation_unref(o);
+}
+
+void OperationBatch::end() {
+    mEnded = true;
+
+    if (mPending.empty())
+        complete();
+}
+
+void OperationBatch::success_cb(pa_context *c, int success, void *userdata) {
+    Operation *op = static_cast<Operation*>(userdata);
+    OperationBatch *b = op->batch;
+
+    if (!success)
+        b->fail(op, pa_strerror(pa_context_errno(c)));
+
+    b->mPending.erase(op);
+    delete op;
+
+    if (b->mEnded && b->mPending.empty())
+        b->complete();
+}
+
+void OperationBatch::fail(Operation *op, const char *error) {
+    mFailed++;
+
+    if (op && !op->label.empty())
+        mFailures.push_back(op->label + ": " + error);
+}
+
+void OperationBatch::complete() {
+    mDone(this);
+    delete this;
+}
@@ -0,0 +1,76 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+
+#ifndef operationbatch_h
+#define operationbatch_h
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "pavucontrol.h"
+
+/* Operations sent to the server back to back and waited for as a whole,
+ * as the bulk actions, snapshot restores, device drains and undo replays
+ * do. Each one is issued with success_cb and the userdata from next().
+ * done gets the batch once the server has answered all of them, possibly
+ * from end(), and the batch deletes itself right after. Deleting it
+ * before then drops the operations still pending, which is only safe
+ * once the connection is gone. */
+class OperationBatch {
+public:
+    OperationBatch(const sigc::slot<void, OperationBatch*> &done);
+    ~OperationBatch();
+
+    /* Userdata for the operation about to be issued, failures of labeled
+     * operations are listed with their label */
+    void* next(const std::string &label = std::string());
+
+    /* Takes what the pa_context_*() call returned, NULL counts as failed */
+    void issue(pa_operation *o);
+
+    /* Everything is issued */
+    void end();
+
+    unsigned operations() const { return mOperations; }
+    unsigned failed() const { return mFailed; }
+    const std::vector<std::string>& failures() const { return mFailures; }
+
+    static void success_cb(pa_context *c, int success, void *userdata);
+
+private:
+    struct Operation {
+        OperationBatch *batch;
+        std::string label;
+    };
+
+    sigc::slot<void, OperationBatch*> mDone;
+    std::set<Operation*> mPending;
+    Operation *mNext;
+    unsigned mOperations, mFailed;
+    bool mEnded;
+    std::vector<std::string> mFailures;
+
+    void fail(Operation *op, const char *error);
+    void complete();
+};
+
+#endif
@@ -22,6 +22,8 @@
 #include <config.h>
 #endif
 
+#include <locale.h>
+
 #include <pulse/pulseaudio.h>
 #include <pulse/glib-mainloop.h>
 #include <pulse/ext-stream-restore.h>
@@ -41,6 +43,7 @@
 #include "sourceoutputwidget.h"
 #include "rolewidget.h"
 #include "mainwindow.h"
+#include "headless.h"
 
 static pa_context* context = NULL;
 static pa_mainloop_api* api = NULL;
@@ -48,6 +51,14 @@ static int n_outstanding = 0;
 static int default_tab = 0;
 static bool retry = false;
 static int reconnect_timeout = 1;
+static int meter_budget = -1;
+static int meter_rate = 0;
+static bool adaptive_meters = false;
+#if HAVE_EXT_DEVICE_RESTORE_API
+/* The formats of every sink are on their way, the sinks of the initial
+ * listing need no read of their own */
+static bool reading_all_formats = false;
+#endif
 
 void show_error(const char *txt) {
     char buf[256];
@@ -89,11 +100,7 @@ void card_cb(pa_context *, const pa_card_info *i, int eol, void *userdata) {
     w->updateCard(*i);
 }
 
-#if HAVE_EXT_DEVICE_RESTORE_API
-static void ext_device_restore_subscribe_cb(pa_context *c, pa_device_type_t type, uint32_t idx, void *userdata);
-#endif
-
-void sink_cb(pa_context *c, const pa_sink_info *i, int eol, void *userdata) {
+void sink_cb(pa_context *, const pa_sink_info *i, int eol, void *userdata) {
     MainWindow *w = static_cast<MainWindow*>(userdata);
 
     if (eol < 0) {
@@ -110,8 +117,8 @@ void sink_cb(pa_context *c, const pa_sink_info *i, int eol, void *userdata) {
     }
 
 #if HAVE_EXT_DEVICE_RESTORE_API
-    if (w->updateSink(*i))
-        ext_device_restore_subscribe_cb(c, PA_DEVICE_TYPE_SINK, i->index, w);
+    if (w->updateSink(*i) && !reading_all_formats)
+        w->queueFormatRead(i->index);
 #else
     w->updateSink(*i);
 #endif
@@ -169,23 +176,27 @@ void source_output_cb(pa_context *, const pa_source_output_info *i, int eol, voi
     if (eol > 0)  {
 
         if (n_outstanding > 0) {
-            /* At this point all notebook pages have been populated, so
-             * let's open one that isn't empty */
+            /* At this point we know everything that goes into the
+             * notebook pages, so let's open one that isn't empty */
             if (default_tab != -1) {
                 if (default_tab < 1 || default_tab > w->notebook->get_n_pages()) {
-                    if (w->sinkInputWidgets.size() > 0)
-                        w->notebook->set_current_page(0);
-                    else if (w->sourceOutputWidgets.size() > 0)
-                        w->notebook->set_current_page(1);
-                    else if (w->sourceWidgets.size() > 0 && w->sinkWidgets.size() == 0)
-                        w->notebook->set_current_page(3);
+                    if (w->sinkInputInfos.size() > 0)
+                        w->notebook->set_current_page(PAGE_PLAYBACK);
+                    else if (w->sourceOutputInfos.size() > 0)
+                        w->notebook->set_current_page(PAGE_RECORDING);
+                    else if (w->sourceInfos.size() > 0 && w->sinkInfos.size() == 0)
+                        w->notebook->set_current_page(PAGE_INPUT_DEVICES);
                     else
-                        w->notebook->set_current_page(2);
+                        w->notebook->set_current_page(PAGE_OUTPUT_DEVICES);
                 } else {
                     w->notebook->set_current_page(default_tab - 1);
                 }
                 default_tab = -1;
             }
+
+            /* Only now create the widgets, starting with the page the
+             * user is going to see */
+            w->buildPages();
         }
 
         dec_outstanding(w);
@@ -237,28 +248,26 @@ void ext_stream_restore_read_cb(
     if (eol < 0) {
         dec_outstanding(w);
         g_debug(_("Failed to initialize stream_restore extension: %s"), pa_strerror(pa_context_errno(context)));
+        w->streamRestore.fail();
         w->deleteEventRoleWidget();
         return;
     }
 
     if (eol > 0) {
+        w->streamRestore.end();
         dec_outstanding(w);
         return;
     }
 
-    w->updateRole(*i);
+    if (w->streamRestore.update(*i))
+        w->updateRole(*i);
 }
 
-static void ext_stream_restore_subscribe_cb(pa_context *c, void *userdata) {
+static void ext_stream_restore_subscribe_cb(pa_context *, void *userdata) {
     MainWindow *w = static_cast<MainWindow*>(userdata);
-    pa_operation *o;
-
-    if (!(o = pa_ext_stream_restore_read(c, ext_stream_restore_read_cb, w))) {
-        show_error(_("pa_ext_stream_restore_read() failed"));
-        return;
-    }
 
-    pa_operation_unref(o);
+    /* Later reads are done by the cache, once per burst of changes */
+    w->streamRestore.queueRead();
 }
 
 #if HAVE_EXT_DEVICE_RESTORE_API
@@ -271,12 +280,14 @@ void ext_device_restore_read_cb(
     MainWindow *w = static_cast<MainWindow*>(userdata);
 
     if (eol < 0) {
+        reading_all_formats = false;
         dec_outstanding(w);
         g_debug(_("Failed to initialize device restore extension: %s"), pa_strerror(pa_context_errno(context)));
         return;
     }
 
     if (eol > 0) {
+        reading_all_formats = false;
         dec_outstanding(w);
         return;
     }
@@ -285,19 +296,13 @@ void ext_device_restore_read_cb(
     w->updateDeviceInfo(*i);
 }
 
-static void ext_device_restore_subscribe_cb(pa_context *c, pa_device_type_t type, uint32_t idx, void *userdata) {
+static void ext_device_restore_subscribe_cb(pa_context *, pa_device_type_t type, uint32_t idx, void *userdata) {
     MainWindow *w = static_cast<MainWindow*>(userdata);
-    pa_operation *o;
 
     if (type != PA_DEVICE_TYPE_SINK)
         return;
 
-    if (!(o = pa_ext_device_restore_read_formats(c, type, idx, ext_device_restore_read_cb, w))) {
-        show_error(_("pa_ext_device_restore_read_sink_formats() failed"));
-        return;
-    }
-
-    pa_operation_unref(o);
+    w->queueFormatRead(idx);
 }
 #endif
 
@@ -526,6 +531,7 @@ void context_state_callback(pa_context *c, void *userdata) {
             if ((o = pa_ext_stream_restore_read(c, ext_stream_restore_read_cb, w))) {
                 pa_operation_unref(o);
                 n_outstanding++;
+                w->streamRestore.begin();
 
                 pa_ext_stream_restore_set_subscribe_cb(c, ext_stream_restore_subscribe_cb, w);
 
@@ -540,6 +546,7 @@ void context_state_callback(pa_context *c, void *userdata) {
             if ((o = pa_ext_device_restore_read_formats_all(c, ext_device_restore_read_cb, w))) {
                 pa_operation_unref(o);
                 n_outstanding++;
+                reading_all_formats = true;
 
                 pa_ext_device_restore_set_subscribe_cb(c, ext_device_restore_subscribe_cb, w);
 
@@ -568,6 +575,9 @@ void context_state_callback(pa_context *c, void *userdata) {
 
         case PA_CONTEXT_FAILED:
             w->setConnectionState(false);
+#if HAVE_EXT_DEVICE_RESTORE_API
+            reading_all_formats = false;
+#endif
 
             w->removeAllWidgets();
             w->updateDeviceVisibility();
@@ -664,14 +674,63 @@ int main(int argc, char *argv[]) {
     entry2.set_description(_("Retry forever if pa quits (every 5 seconds)."));
     group.add_entry(entry2, retry);
 
+    Glib::OptionEntry entry3;
+    entry3.set_long_name("meter-budget");
+    entry3.set_short_name('b');
+    entry3.set_description(_("Maximum number of level meter streams open at once (0 for no limit)."));
+    group.add_entry(entry3, meter_budget);
+
+    Glib::OptionEntry entry4;
+    entry4.set_long_name("meter-rate");
+    entry4.set_description(_("Level meter updates per second."));
+    group.add_entry(entry4, meter_rate);
+
+    Glib::OptionEntry entry5;
+    entry5.set_long_name("adaptive-meters");
+    entry5.set_description(_("Slow down level meters while the level is steady or silent."));
+    group.add_entry(entry5, adaptive_meters);
+
+    bool dump = false;
+    Glib::OptionEntry entry6;
+    entry6.set_long_name("dump");
+    entry6.set_description(_("Print the state of the sound server as JSON and exit, without opening a window."));
+    group.add_entry(entry6, dump);
+
+    bool watch = false;
+    Glib::OptionEntry entry7;
+    entry7.set_long_name("watch");
+    entry7.set_description(_("Print a JSON line for every change on the sound server, without opening a window."));
+    group.add_entry(entry7, watch);
+
     options.set_main_group(group);
 
     try {
+        /* The headless modes must not initialize GTK, so our own options
+         * are looked at before Gtk::Main parses the rest */
+        options.set_help_enabled(false);
+        options.set_ignore_unknown_options(true);
+        options.parse(argc, argv);
+        options.set_help_enabled(true);
+        options.set_ignore_unknown_options(false);
+
+        if (dump || watch) {
+            setlocale(LC_ALL, "");
+            return dump ? headless_dump() : headless_watch();
+        }
+
         Gtk::Main kit(argc, argv, options);
 
         ca_context_set_driver(ca_gtk_context_get(), "pulse");
 
         MainWindow* mainWindow = MainWindow::create();
+        mainWindow->controlSocket.start();
+
+        if (meter_budget >= 0)
+            mainWindow->meterScheduler.setBudget(meter_budget);
+
+        if (meter_rate > 0 || adaptive_meters)
+            mainWindow->meterScheduler.setRate(meter_rate > 0 ? meter_rate : mainWindow->meterScheduler.getRate(),
+                                               adaptive_meters || mainWindow->meterScheduler.isAdaptive());
 
         pa_glib_mainloop *m = pa_glib_mainloop_new(g_main_context_default());
         g_assert(m);
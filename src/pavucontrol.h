@@ -68,6 +68,15 @@ enum SourceType {
     SOURCE_MONITOR,
 };
 
+enum NotebookPage {
+    PAGE_PLAYBACK,
+    PAGE_RECORDING,
+    PAGE_OUTPUT_DEVICES,
+    PAGE_INPUT_DEVICES,
+    PAGE_CONFIGURATION,
+    N_PAGES
+};
+
 pa_context* get_context(void);
 void show_error(const char *txt);
 
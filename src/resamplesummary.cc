@@ -0,0 +1,209 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include "resamplesummary.h"
+#include "mainwindow.h"
+
+#include "i18n.h"
+
+/* Rows in the expanded list */
+#define SUMMARY_MAX_ROWS 20
+
+/* What each method costs per channel and sample compared to the others.
+ * The speex methods are weighted by their quality, which is the length of
+ * their filter. */
+static double method_weight(const char *method) {
+    static const struct {
+        const char *name;
+        double weight;
+    } weights[] = {
+        { "copy", 0.1 },
+        { "trivial", 0.5 },
+        { "peaks", 0.5 },
+        { "src-zero-order-hold", 1 },
+        { "src-linear", 1 },
+        { "src-sinc-fastest", 4 },
+        { "src-sinc-medium-quality", 8 },
+        { "src-sinc-best-quality", 16 },
+        { "soxr-mq", 2 },
+        { "soxr-hq", 3 },
+        { "soxr-vhq", 5 },
+        { "ffmpeg", 2 },
+        { NULL, 0 }
+    };
+    int quality;
+
+    if (!method)
+        return 0;
+
+    if (sscanf(method, "speex-float-%d", &quality) == 1 || sscanf(method, "speex-fixed-%d", &quality) == 1)
+        return 1 + CLAMP(quality, 0, 10);
+
+    for (unsigned i = 0; weights[i].name; i++)
+        if (strcmp(method, weights[i].name) == 0)
+            return weights[i].weight;
+
+    return 2;
+}
+
+/* Resampling when the server does more than copy the samples */
+static bool resamples(const char *method) {
+    return method && strcmp(method, "copy") != 0;
+}
+
+/*** ResampleSummary ***/
+ResampleSummary::ResampleSummary(MainWindow *w, bool recording) :
+    mpMainWindow(w),
+    mRecording(recording) {
+
+    titleLabel.set_alignment(0, 0.5);
+    set_label_widget(titleLabel);
+
+    listLabel.set_alignment(0, 0);
+    listLabel.set_padding(12, 6);
+    listLabel.set_selectable(true);
+    add(listLabel);
+
+    property_expanded().signal_changed().connect(sigc::mem_fun(*this, &ResampleSummary::onExpanded));
+
+    set_border_width(6);
+    titleLabel.show();
+    listLabel.show();
+}
+
+double ResampleSummary::cost(const pa_sample_spec &stream, const pa_sample_spec &device, const char *method) {
+    double ratio;
+
+    if (!method || !pa_sample_spec_valid(&stream) || !pa_sample_spec_valid(&device))
+        return 0;
+
+    /* The filter runs at the higher of the two rates */
+    ratio = stream.rate > device.rate ? (double) stream.rate / device.rate : (double) device.rate / stream.rate;
+
+    return ratio * MAX(stream.channels, device.channels) * method_weight(method);
+}
+
+void ResampleSummary::queueUpdate() {
+    if (!updateConnection.connected())
+        updateConnection = Glib::signal_idle().connect(sigc::mem_fun(*this, &ResampleSummary::onUpdateIdle), Glib::PRIORITY_LOW);
+}
+
+void ResampleSummary::onExpanded() {
+    queueUpdate();
+}
+
+bool ResampleSummary::onUpdateIdle() {
+    std::vector<std::pair<double, uint32_t> > ranked;
+    unsigned total = 0;
+    double sum = 0;
+    gchar *txt;
+
+    if (mRecording) {
+        for (IndexMap<pa_source_output_info*>::iterator i = mpMainWindow->sourceOutputInfos.begin(); i != mpMainWindow->sourceOutputInfos.end(); ++i) {
+            pa_source_info **device = mpMainWindow->sourceInfos.find(i->second->source);
+
+            total++;
+            if (device && resamples(i->second->resample_method))
+                ranked.push_back(std::make_pair(cost(i->second->sample_spec, (*device)->sample_spec, i->second->resample_method), i->first));
+        }
+    } else {
+        for (IndexMap<pa_sink_input_info*>::iterator i = mpMainWindow->sinkInputInfos.begin(); i != mpMainWindow->sinkInputInfos.end(); ++i) {
+            pa_sink_info **device = mpMainWindow->sinkInfos.find(i->second->sink);
+
+            total++;
+            if (device && resamples(i->second->resample_method))
+                ranked.push_back(std::make_pair(cost(i->second->sample_spec, (*device)->sample_spec, i->second->resample_method), i->first));
+        }
+    }
+
+    for (size_t i = 0; i < ranked.size(); i++)
+        sum += ranked[i].first;
+
+    titleLabel.set_markup(txt = g_markup_printf_escaped(_("<b>Resampling:</b> %u of %u streams, estimated cost %.0f"), (unsigned) ranked.size(), total, sum));
+    g_free(txt);
+
+    if (ranked.empty())
+        hide();
+    else
+        show();
+
+    if (!get_expanded() || ranked.empty())
+        return false;
+
+    /* Only the costliest few are listed, the rest need no order */
+    std::partial_sort(ranked.begin(), ranked.begin() + MIN(ranked.size(), (size_t) SUMMARY_MAX_ROWS), ranked.end(),
+                      std::greater<std::pair<double, uint32_t> >());
+
+    Glib::ustring markup;
+
+    for (size_t i = 0; i < ranked.size() && i < SUMMARY_MAX_ROWS; i++) {
+        char s[PA_SAMPLE_SPEC_SNPRINT_MAX], d[PA_SAMPLE_SPEC_SNPRINT_MAX];
+        const char *client, *name, *method;
+        uint32_t clientIndex;
+
+        if (mRecording) {
+            pa_source_output_info *info = *mpMainWindow->sourceOutputInfos.find(ranked[i].second);
+
+            pa_sample_spec_snprint(s, sizeof(s), &info->sample_spec);
+            pa_sample_spec_snprint(d, sizeof(d), &(*mpMainWindow->sourceInfos.find(info->source))->sample_spec);
+            clientIndex = info->client;
+            name = info->name;
+            method = info->resample_method;
+        } else {
+            pa_sink_input_info *info = *mpMainWindow->sinkInputInfos.find(ranked[i].second);
+
+            pa_sample_spec_snprint(s, sizeof(s), &info->sample_spec);
+            pa_sample_spec_snprint(d, sizeof(d), &(*mpMainWindow->sinkInfos.find(info->sink))->sample_spec);
+            clientIndex = info->client;
+            name = info->name;
+            method = info->resample_method;
+        }
+
+        if (!(client = mpMainWindow->clients.name(clientIndex)))
+            client = _("Unknown client");
+
+        if (i > 0)
+            markup += "\n";
+        markup += txt = g_markup_printf_escaped(_("%.0f\t<b>%s</b>: %s\n\t<small>%s to %s with %s</small>"), ranked[i].first, client, name ? name : "", s, d, method);
+        g_free(txt);
+    }
+
+    if (ranked.size() > SUMMARY_MAX_ROWS) {
+        markup += "\n";
+        markup += txt = g_markup_printf_escaped(_("<i>and %u more</i>"), (unsigned) (ranked.size() - SUMMARY_MAX_ROWS));
+        g_free(txt);
+    }
+
+    listLabel.set_markup(markup);
+
+    return false;
+}
@@ -0,0 +1,56 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+
+#ifndef resamplesummary_h
+#define resamplesummary_h
+
+#include "pavucontrol.h"
+
+class MainWindow;
+
+/* The streams of the playback or recording page that the server has to
+ * resample, costliest first. The costs are rough relative estimates to
+ * tell which streams keep the server busy, not CPU time. The ranking is
+ * only worked out while the list is expanded. */
+class ResampleSummary : public Gtk::Expander {
+public:
+    ResampleSummary(MainWindow *w, bool recording);
+
+    /* Recomputes from an idle callback, after a stream or device changed
+     * its sample spec, resampler or device */
+    void queueUpdate();
+
+    /* Relative cost of converting between a stream and its device with
+     * the given resampler, 0 for none */
+    static double cost(const pa_sample_spec &stream, const pa_sample_spec &device, const char *method);
+
+private:
+    MainWindow *mpMainWindow;
+    bool mRecording;
+
+    Gtk::Label titleLabel, listLabel;
+    sigc::connection updateConnection;
+
+    bool onUpdateIdle();
+    void onExpanded();
+};
+
+#endif
@@ -23,6 +23,7 @@
 #endif
 
 #include "rolewidget.h"
+#include "mainwindow.h"
 
 #include <pulse/ext-stream-restore.h>
 
@@ -50,6 +51,9 @@ bool RoleWidget::onContextTriggerEvent(GdkEventButton*) {
 void RoleWidget::onMuteToggleButton() {
     StreamWidget::onMuteToggleButton();
 
+    if (!updating && mpMainWindow->fader.fadeMute(VolumeFader::EVENT_ROLE, 0, muteToggleButton->get_active()))
+        return;
+
     executeVolumeUpdate();
 }
 
@@ -59,6 +63,8 @@ void RoleWidget::executeVolumeUpdate() {
     if (updating)
         return;
 
+    mpMainWindow->fader.cancel(VolumeFader::EVENT_ROLE, 0);
+
     info.name = role.c_str();
     info.channel_map.channels = 1;
     info.channel_map.map[0] = PA_CHANNEL_POSITION_MONO;
@@ -0,0 +1,141 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+
+#include "searchindex.h"
+
+/* The properties worth searching, the rest are ids and paths */
+static const char * const search_properties[] = {
+    PA_PROP_MEDIA_NAME,
+    PA_PROP_MEDIA_TITLE,
+    PA_PROP_MEDIA_ARTIST,
+    PA_PROP_MEDIA_ROLE,
+    PA_PROP_APPLICATION_NAME,
+    PA_PROP_APPLICATION_ID,
+    PA_PROP_APPLICATION_PROCESS_BINARY,
+    PA_PROP_DEVICE_DESCRIPTION,
+    PA_PROP_DEVICE_PRODUCT_NAME,
+    PA_PROP_DEVICE_VENDOR_NAME,
+    PA_PROP_DEVICE_BUS,
+    PA_PROP_DEVICE_FORM_FACTOR,
+    PA_PROP_DEVICE_PROFILE_DESCRIPTION,
+    NULL
+};
+
+static void append(std::string &s, const char *text) {
+    gchar *lower;
+
+    if (!text || !*text)
+        return;
+
+    lower = g_utf8_strdown(text, -1);
+    s += lower;
+    s += '\n';
+    g_free(lower);
+}
+
+/*** SearchIndex ***/
+bool SearchIndex::update(Table table, uint32_t index, pa_proplist *proplist, const char *name, const char *description) {
+    std::string text;
+    bool is_new;
+
+    append(text, name);
+    append(text, description);
+
+    if (proplist)
+        for (unsigned i = 0; search_properties[i]; i++)
+            append(text, pa_proplist_gets(proplist, search_properties[i]));
+
+    std::string &stored = tables[table].insert(index, &is_new);
+
+    if (!is_new && stored == text)
+        return false;
+
+    stored.swap(text);
+    return true;
+}
+
+void SearchIndex::remove(Table table, uint32_t index) {
+    tables[table].erase(index);
+}
+
+void SearchIndex::clear() {
+    for (int i = 0; i < N_TABLES; i++)
+        tables[i].clear();
+}
+
+void SearchIndex::parse(const Glib::ustring &text, Terms *terms) {
+    gchar *lower = g_utf8_strdown(text.c_str(), -1);
+    gchar **words = g_strsplit_set(lower, " \t\n", -1);
+
+    terms->clear();
+    for (gchar **w = words; *w; w++)
+        if (**w)
+            terms->push_back(*w);
+
+    g_strfreev(words);
+    g_free(lower);
+}
+
+bool SearchIndex::contains(Table table, uint32_t index, const char *term) {
+    std::string *text;
+
+    if (index == PA_INVALID_INDEX || !(text = tables[table].find(index)))
+        return false;
+
+    return text->find(term) != std::string::npos;
+}
+
+bool SearchIndex::matches(Table table, uint32_t index, const Terms &terms, uint32_t client, uint32_t device) {
+    Table deviceTable = table == SOURCE_OUTPUTS ? SOURCES : SINKS;
+
+    for (Terms::const_iterator i = terms.begin(); i != terms.end(); ++i) {
+        const char *term = i->c_str();
+
+        if (contains(table, index, term) || contains(CLIENTS, client, term))
+            continue;
+
+        if ((table == SINK_INPUTS || table == SOURCE_OUTPUTS) && contains(deviceTable, device, term))
+            continue;
+
+        return false;
+    }
+
+    return true;
+}
+
+bool SearchIndex::matches(const char *text, const Terms &terms) {
+    gchar *lower;
+    bool found = true;
+
+    if (terms.empty())
+        return true;
+
+    lower = g_utf8_strdown(text, -1);
+    for (Terms::const_iterator i = terms.begin(); i != terms.end() && found; ++i)
+        found = strstr(lower, i->c_str()) != NULL;
+    g_free(lower);
+
+    return found;
+}
@@ -0,0 +1,68 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+
+#ifndef searchindex_h
+#define searchindex_h
+
+#include <string>
+#include <vector>
+
+#include "pavucontrol.h"
+#include "indexmap.h"
+
+/* Lowercased text of every object for the filter entries, updated along
+ * with the server model so that filtering never reads the widgets. A
+ * stream also matches on the name of its client and the description of
+ * its device, which are looked up in their own tables when matching so
+ * that renaming one does not touch its streams. */
+class SearchIndex {
+public:
+    enum Table {
+        CARDS,
+        SINKS,
+        SOURCES,
+        SINK_INPUTS,
+        SOURCE_OUTPUTS,
+        CLIENTS,
+        N_TABLES
+    };
+
+    typedef std::vector<std::string> Terms;
+
+    /* Returns whether the text changed */
+    bool update(Table table, uint32_t index, pa_proplist *proplist, const char *name, const char *description = NULL);
+    void remove(Table table, uint32_t index);
+    void clear();
+
+    /* Splits the filter text into lowercase terms, all of which have to
+     * match */
+    static void parse(const Glib::ustring &text, Terms *terms);
+
+    bool matches(Table table, uint32_t index, const Terms &terms, uint32_t client = PA_INVALID_INDEX, uint32_t device = PA_INVALID_INDEX);
+    static bool matches(const char *text, const Terms &terms);
+
+private:
+    IndexMap<std::string> tables[N_TABLES];
+
+    bool contains(Table table, uint32_t index, const char *term);
+};
+
+#endif
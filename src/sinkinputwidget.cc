@@ -29,7 +29,8 @@
 #include "i18n.h"
 
 SinkInputWidget::SinkInputWidget(BaseObjectType* cobject, const Glib::RefPtr<Gtk::Builder>& x) :
-    StreamWidget(cobject, x) {
+    StreamWidget(cobject, x),
+    mSinkIndex(PA_INVALID_INDEX) {
 
     gchar *txt;
     directionLabel->set_label(txt = g_markup_printf_escaped("<i>%s</i>", _("on")));
@@ -47,18 +48,21 @@ SinkInputWidget* SinkInputWidget::create(MainWindow* mainWindow) {
 }
 
 SinkInputWidget::~SinkInputWidget(void) {
-    clearMenu();
 }
 
 void SinkInputWidget::setSinkIndex(uint32_t idx) {
     mSinkIndex = idx;
 
-    if (mpMainWindow->sinkWidgets.count(idx)) {
-        SinkWidget *w = mpMainWindow->sinkWidgets[idx];
-        deviceButton->set_label(w->description.c_str());
-    }
+    pa_sink_info **info = mpMainWindow->sinkInfos.find(idx);
+    pa_sink_input_info **stream = mpMainWindow->sinkInputInfos.find(index);
+
+    if (info)
+        deviceButton->set_label((*info)->description);
     else
         deviceButton->set_label(_("Unknown output"));
+
+    if (stream)
+        setFormat((*stream)->sample_spec, info ? &(*info)->sample_spec : NULL, (*stream)->resample_method);
 }
 
 uint32_t SinkInputWidget::sinkIndex() {
@@ -68,6 +72,9 @@ uint32_t SinkInputWidget::sinkIndex() {
 void SinkInputWidget::executeVolumeUpdate() {
     pa_operation* o;
 
+    mpMainWindow->history.recordVolume(UndoHistory::SINK_INPUT, index, volume);
+    mpMainWindow->fader.cancel(VolumeFader::SINK_INPUT, index);
+
     if (!(o = pa_context_set_sink_input_volume(get_context(), index, &volume, NULL, NULL))) {
         show_error(_("pa_context_set_sink_input_volume() failed"));
         return;
@@ -82,6 +89,11 @@ void SinkInputWidget::onMuteToggleButton() {
     if (updating)
         return;
 
+    mpMainWindow->history.recordMute(UndoHistory::SINK_INPUT, index, muteToggleButton->get_active());
+
+    if (mpMainWindow->fader.fadeMute(VolumeFader::SINK_INPUT, index, muteToggleButton->get_active()))
+        return;
+
     pa_operation* o;
     if (!(o = pa_context_set_sink_input_mute(get_context(), index, muteToggleButton->get_active(), NULL, NULL))) {
         show_error(_("pa_context_set_sink_input_mute() failed"));
@@ -101,44 +113,14 @@ void SinkInputWidget::onKill() {
     pa_operation_unref(o);
 }
 
-void SinkInputWidget::clearMenu() {
-  while (!sinkMenuItems.empty()) {
-    std::map<uint32_t, SinkMenuItem*>::iterator i = sinkMenuItems.begin();
-    delete i->second;
-    sinkMenuItems.erase(i);
-  }
-}
-
-void SinkInputWidget::buildMenu() {
-  for (std::map<uint32_t, SinkWidget*>::iterator i = mpMainWindow->sinkWidgets.begin(); i != mpMainWindow->sinkWidgets.end(); ++i) {
-    SinkMenuItem *m;
-    sinkMenuItems[i->second->index] = m = new SinkMenuItem(this, i->second->description.c_str(), i->second->index, i->second->index == mSinkIndex);
-    menu.append(m->menuItem);
-  }
-  menu.show_all();
+void SinkInputWidget::onDeviceChangePopup() {
+    /* The row may show another stream by the time a device is picked */
+    mpMainWindow->sinkMenu.popup(mSinkIndex, sigc::bind<0>(sigc::mem_fun(*mpMainWindow, &MainWindow::moveSinkInput), index));
 }
 
-void SinkInputWidget::SinkMenuItem::onToggle() {
-  if (widget->updating)
-    return;
-
-  if (!menuItem.get_active())
-    return;
-
-  /*if (!mpMainWindow->sinkWidgets.count(widget->index))
-    return;*/
-
-  pa_operation* o;
-  if (!(o = pa_context_move_sink_input_by_index(get_context(), widget->index, index, NULL, NULL))) {
-    show_error(_("pa_context_move_sink_input_by_index() failed"));
-    return;
-  }
-
-  pa_operation_unref(o);
-}
+void SinkInputWidget::onSelectToggled() {
+    if (updating)
+        return;
 
-void SinkInputWidget::onDeviceChangePopup() {
-    clearMenu();
-    buildMenu();
-    menu.popup(1, 0);
+    mpMainWindow->playbackSelection.select(index, selectButton.get_active());
 }
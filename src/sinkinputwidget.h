@@ -41,33 +41,11 @@ public:
     virtual void executeVolumeUpdate();
     virtual void onMuteToggleButton();
     virtual void onDeviceChangePopup();
+    virtual void onSelectToggled();
     virtual void onKill();
 
 private:
     uint32_t mSinkIndex;
-
-    void clearMenu();
-    void buildMenu();
-
-    Gtk::Menu menu;
-
-    struct SinkMenuItem {
-      SinkMenuItem(SinkInputWidget *w, const char *label, uint32_t i, bool active) :
-      widget(w),
-      menuItem(label),
-      index(i) {
-        menuItem.set_active(active);
-        menuItem.set_draw_as_radio(true);
-        menuItem.signal_toggled().connect(sigc::mem_fun(*this, &SinkMenuItem::onToggle));
-      }
-
-      SinkInputWidget *widget;
-      Gtk::CheckMenuItem menuItem;
-      uint32_t index;
-      void onToggle();
-    };
-
-    std::map<uint32_t, SinkMenuItem*> sinkMenuItems;
 };
 
 #endif
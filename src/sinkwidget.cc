@@ -23,6 +23,8 @@
 #endif
 
 #include "sinkwidget.h"
+#include "mainwindow.h"
+#include "devicedrain.h"
 
 #include <canberra-gtk.h>
 #if HAVE_EXT_DEVICE_RESTORE_API
@@ -78,6 +80,9 @@ void SinkWidget::executeVolumeUpdate() {
     char dev[64];
     int playing = 0;
 
+    mpMainWindow->history.recordVolume(UndoHistory::SINK, index, volume);
+    mpMainWindow->fader.cancel(VolumeFader::SINK, index);
+
     if (!(o = pa_context_set_sink_volume_by_index(get_context(), index, &volume, NULL, NULL))) {
         show_error(_("pa_context_set_sink_volume_by_index() failed"));
         return;
@@ -109,6 +114,11 @@ void SinkWidget::onMuteToggleButton() {
     if (updating)
         return;
 
+    mpMainWindow->history.recordMute(UndoHistory::SINK, index, muteToggleButton->get_active());
+
+    if (mpMainWindow->fader.fadeMute(VolumeFader::SINK, index, muteToggleButton->get_active()))
+        return;
+
     pa_operation* o;
     if (!(o = pa_context_set_sink_mute_by_index(get_context(), index, muteToggleButton->get_active(), NULL, NULL))) {
         show_error(_("pa_context_set_sink_mute_by_index() failed"));
@@ -124,6 +134,8 @@ void SinkWidget::onDefaultToggleButton() {
     if (updating)
         return;
 
+    mpMainWindow->history.recordDefault(UndoHistory::SINK, name.c_str());
+
     if (!(o = pa_context_set_default_sink(get_context(), name.c_str(), NULL, NULL))) {
         show_error(_("pa_context_set_default_sink() failed"));
         return;
@@ -144,6 +156,8 @@ void SinkWidget::onPortChange() {
             pa_operation* o;
             Glib::ustring port = row[portModel.name];
 
+            mpMainWindow->history.recordPort(UndoHistory::SINK, index, port.c_str());
+
             if (!(o = pa_context_set_sink_port_by_index(get_context(), index, port.c_str(), NULL, NULL))) {
                 show_error(_("pa_context_set_sink_port_by_index() failed"));
                 return;
@@ -154,6 +168,14 @@ void SinkWidget::onPortChange() {
     }
 }
 
+void SinkWidget::onDrainPopup() {
+    mpMainWindow->sinkMenu.popup(index, sigc::mem_fun(*this, &SinkWidget::onDrainTo));
+}
+
+void SinkWidget::onDrainTo(uint32_t sink) {
+    DeviceDrain::start(mpMainWindow, false, index, sink);
+}
+
 void SinkWidget::setDigital(bool digital) {
 #if HAVE_EXT_DEVICE_RESTORE_API
     if (digital)
@@ -57,6 +57,10 @@ public:
 protected:
     virtual void onPortChange();
     virtual void onEncodingsChange();
+    virtual void onDrainPopup();
+
+private:
+    void onDrainTo(uint32_t sink);
 };
 
 #endif
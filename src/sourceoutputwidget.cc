@@ -29,7 +29,8 @@
 #include "i18n.h"
 
 SourceOutputWidget::SourceOutputWidget(BaseObjectType* cobject, const Glib::RefPtr<Gtk::Builder>& x) :
-    StreamWidget(cobject, x) {
+    StreamWidget(cobject, x),
+    mSourceIndex(PA_INVALID_INDEX) {
 
     gchar *txt;
     directionLabel->set_label(txt = g_markup_printf_escaped("<i>%s</i>", _("from")));
@@ -53,18 +54,21 @@ SourceOutputWidget* SourceOutputWidget::create(MainWindow* mainWindow) {
 }
 
 SourceOutputWidget::~SourceOutputWidget(void) {
-  clearMenu();
 }
 
 void SourceOutputWidget::setSourceIndex(uint32_t idx) {
     mSourceIndex = idx;
 
-    if (mpMainWindow->sourceWidgets.count(idx)) {
-      SourceWidget *w = mpMainWindow->sourceWidgets[idx];
-      deviceButton->set_label(w->description.c_str());
-    }
+    pa_source_info **info = mpMainWindow->sourceInfos.find(idx);
+    pa_source_output_info **stream = mpMainWindow->sourceOutputInfos.find(index);
+
+    if (info)
+      deviceButton->set_label((*info)->description);
     else
       deviceButton->set_label(_("Unknown input"));
+
+    if (stream)
+      setFormat((*stream)->sample_spec, info ? &(*info)->sample_spec : NULL, (*stream)->resample_method);
 }
 
 uint32_t SourceOutputWidget::sourceIndex() {
@@ -75,6 +79,9 @@ uint32_t SourceOutputWidget::sourceIndex() {
 void SourceOutputWidget::executeVolumeUpdate() {
     pa_operation* o;
 
+    mpMainWindow->history.recordVolume(UndoHistory::SOURCE_OUTPUT, index, volume);
+    mpMainWindow->fader.cancel(VolumeFader::SOURCE_OUTPUT, index);
+
     if (!(o = pa_context_set_source_output_volume(get_context(), index, &volume, NULL, NULL))) {
         show_error(_("pa_context_set_source_output_volume() failed"));
         return;
@@ -89,6 +96,11 @@ void SourceOutputWidget::onMuteToggleButton() {
     if (updating)
         return;
 
+    mpMainWindow->history.recordMute(UndoHistory::SOURCE_OUTPUT, index, muteToggleButton->get_active());
+
+    if (mpMainWindow->fader.fadeMute(VolumeFader::SOURCE_OUTPUT, index, muteToggleButton->get_active()))
+        return;
+
     pa_operation* o;
     if (!(o = pa_context_set_source_output_mute(get_context(), index, muteToggleButton->get_active(), NULL, NULL))) {
         show_error(_("pa_context_set_source_output_mute() failed"));
@@ -110,44 +122,14 @@ void SourceOutputWidget::onKill() {
 }
 
 
-void SourceOutputWidget::clearMenu() {
-  while (!sourceMenuItems.empty()) {
-    std::map<uint32_t, SourceMenuItem*>::iterator i = sourceMenuItems.begin();
-    delete i->second;
-    sourceMenuItems.erase(i);
-  }
-}
-
-void SourceOutputWidget::buildMenu() {
-  for (std::map<uint32_t, SourceWidget*>::iterator i = mpMainWindow->sourceWidgets.begin(); i != mpMainWindow->sourceWidgets.end(); ++i) {
-    SourceMenuItem *m;
-    sourceMenuItems[i->second->index] = m = new SourceMenuItem(this, i->second->description.c_str(), i->second->index, i->second->index == mSourceIndex);
-    menu.append(m->menuItem);
-  }
-  menu.show_all();
+void SourceOutputWidget::onDeviceChangePopup() {
+    /* The row may show another stream by the time a device is picked */
+    mpMainWindow->sourceMenu.popup(mSourceIndex, sigc::bind<0>(sigc::mem_fun(*mpMainWindow, &MainWindow::moveSourceOutput), index));
 }
 
-void SourceOutputWidget::SourceMenuItem::onToggle() {
-  if (widget->updating)
-    return;
-
-  if (!menuItem.get_active())
-    return;
-
-  /*if (!mpMainWindow->sourceWidgets.count(widget->index))
-    return;*/
-
-  pa_operation* o;
-  if (!(o = pa_context_move_source_output_by_index(get_context(), widget->index, index, NULL, NULL))) {
-    show_error(_("pa_context_move_source_output_by_index() failed"));
-    return;
-  }
-
-  pa_operation_unref(o);
-}
+void SourceOutputWidget::onSelectToggled() {
+    if (updating)
+        return;
 
-void SourceOutputWidget::onDeviceChangePopup() {
-    clearMenu();
-    buildMenu();
-    menu.popup(1, 0);
+    mpMainWindow->recordingSelection.select(index, selectButton.get_active());
 }
@@ -43,33 +43,11 @@ public:
     virtual void onMuteToggleButton();
 #endif
     virtual void onDeviceChangePopup();
+    virtual void onSelectToggled();
     virtual void onKill();
 
 private:
     uint32_t mSourceIndex;
-
-    void clearMenu();
-    void buildMenu();
-
-    Gtk::Menu menu;
-
-    struct SourceMenuItem {
-      SourceMenuItem(SourceOutputWidget *w, const char *label, uint32_t i, bool active) :
-      widget(w),
-      menuItem(label),
-      index(i) {
-        menuItem.set_active(active);
-        menuItem.set_draw_as_radio(true);
-        menuItem.signal_toggled().connect(sigc::mem_fun(*this, &SourceMenuItem::onToggle));
-      }
-
-      SourceOutputWidget *widget;
-      Gtk::CheckMenuItem menuItem;
-      uint32_t index;
-      void onToggle();
-    };
-
-    std::map<uint32_t, SourceMenuItem*> sourceMenuItems;
 };
 
 #endif
@@ -23,6 +23,8 @@
 #endif
 
 #include "sourcewidget.h"
+#include "mainwindow.h"
+#include "devicedrain.h"
 
 #include "i18n.h"
 
@@ -41,6 +43,9 @@ SourceWidget* SourceWidget::create(MainWindow* mainWindow) {
 void SourceWidget::executeVolumeUpdate() {
     pa_operation* o;
 
+    mpMainWindow->history.recordVolume(UndoHistory::SOURCE, index, volume);
+    mpMainWindow->fader.cancel(VolumeFader::SOURCE, index);
+
     if (!(o = pa_context_set_source_volume_by_index(get_context(), index, &volume, NULL, NULL))) {
         show_error(_("pa_context_set_source_volume_by_index() failed"));
         return;
@@ -55,6 +60,11 @@ void SourceWidget::onMuteToggleButton() {
     if (updating)
         return;
 
+    mpMainWindow->history.recordMute(UndoHistory::SOURCE, index, muteToggleButton->get_active());
+
+    if (mpMainWindow->fader.fadeMute(VolumeFader::SOURCE, index, muteToggleButton->get_active()))
+        return;
+
     pa_operation* o;
     if (!(o = pa_context_set_source_mute_by_index(get_context(), index, muteToggleButton->get_active(), NULL, NULL))) {
         show_error(_("pa_context_set_source_mute_by_index() failed"));
@@ -70,6 +80,8 @@ void SourceWidget::onDefaultToggleButton() {
     if (updating)
         return;
 
+    mpMainWindow->history.recordDefault(UndoHistory::SOURCE, name.c_str());
+
     if (!(o = pa_context_set_default_source(get_context(), name.c_str(), NULL, NULL))) {
         show_error(_("pa_context_set_default_source() failed"));
         return;
@@ -92,6 +104,8 @@ void SourceWidget::onPortChange() {
       pa_operation* o;
       Glib::ustring port = row[portModel.name];
 
+      mpMainWindow->history.recordPort(UndoHistory::SOURCE, index, port.c_str());
+
       if (!(o = pa_context_set_source_port_by_index(get_context(), index, port.c_str(), NULL, NULL))) {
         show_error(_("pa_context_set_source_port_by_index() failed"));
         return;
@@ -101,3 +115,11 @@ void SourceWidget::onPortChange() {
     }
   }
 }
+
+void SourceWidget::onDrainPopup() {
+    mpMainWindow->sourceMenu.popup(index, sigc::mem_fun(*this, &SourceWidget::onDrainTo));
+}
+
+void SourceWidget::onDrainTo(uint32_t source) {
+    DeviceDrain::start(mpMainWindow, true, index, source);
+}
@@ -39,6 +39,10 @@ public:
 
 protected:
     virtual void onPortChange();
+    virtual void onDrainPopup();
+
+private:
+    void onDrainTo(uint32_t source);
 };
 
 #endif
@@ -0,0 +1,147 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+
+#include "streamrestorecache.h"
+#include "mainwindow.h"
+
+#include "i18n.h"
+
+/*** StreamRestoreCache ***/
+StreamRestoreCache::StreamRestoreCache(MainWindow *mainWindow) :
+    mpMainWindow(mainWindow),
+    mGeneration(0),
+    reading(false),
+    dirty(false) {
+}
+
+StreamRestoreCache::~StreamRestoreCache() {
+    readConnection.disconnect();
+}
+
+void StreamRestoreCache::begin() {
+    reading = true;
+    mGeneration++;
+}
+
+bool StreamRestoreCache::update(const pa_ext_stream_restore_info &info) {
+    std::map<std::string, Entry>::iterator i = entries.find(info.name);
+    const char *device = info.device ? info.device : "";
+
+    if (i == entries.end())
+        i = entries.insert(std::make_pair(std::string(info.name), Entry())).first;
+    else if (i->second.device == device &&
+             i->second.mute == info.mute &&
+             pa_channel_map_equal(&i->second.channelMap, &info.channel_map) &&
+             pa_cvolume_equal(&i->second.volume, &info.volume)) {
+        i->second.generation = mGeneration;
+        return false;
+    }
+
+    Entry &e = i->second;
+    e.device = device;
+    e.channelMap = info.channel_map;
+    e.volume = info.volume;
+    e.mute = info.mute;
+    e.generation = mGeneration;
+
+    return true;
+}
+
+void StreamRestoreCache::end() {
+    std::map<std::string, Entry>::iterator i, next;
+
+    /* Whatever the read did not return has been deleted */
+    for (i = entries.begin(); i != entries.end(); i = next) {
+        next = i;
+        ++next;
+
+        if (i->second.generation != mGeneration)
+            entries.erase(i);
+    }
+
+    reading = false;
+
+    if (dirty)
+        queueRead();
+}
+
+void StreamRestoreCache::fail() {
+    reading = false;
+    dirty = false;
+}
+
+void StreamRestoreCache::queueRead() {
+    dirty = true;
+
+    if (reading || readConnection.connected())
+        return;
+
+    readConnection = Glib::signal_idle().connect(sigc::mem_fun(*this, &StreamRestoreCache::onRead));
+}
+
+void StreamRestoreCache::clear() {
+    readConnection.disconnect();
+    entries.clear();
+    reading = false;
+    dirty = false;
+}
+
+size_t StreamRestoreCache::size() const {
+    return entries.size();
+}
+
+bool StreamRestoreCache::onRead() {
+    pa_operation *o;
+
+    dirty = false;
+
+    if (!(o = pa_ext_stream_restore_read(get_context(), read_cb, this))) {
+        show_error(_("pa_ext_stream_restore_read() failed"));
+        return false;
+    }
+
+    pa_operation_unref(o);
+    begin();
+
+    return false;
+}
+
+void StreamRestoreCache::read_cb(pa_context *, const pa_ext_stream_restore_info *i, int eol, void *userdata) {
+    StreamRestoreCache *c = static_cast<StreamRestoreCache*>(userdata);
+
+    if (eol < 0) {
+        g_debug(_("Failed to read the stream restore database: %s"), pa_strerror(pa_context_errno(get_context())));
+        c->fail();
+        return;
+    }
+
+    if (eol > 0) {
+        c->end();
+        return;
+    }
+
+    if (c->update(*i))
+        c->mpMainWindow->updateRole(*i);
+}
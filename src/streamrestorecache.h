@@ -0,0 +1,73 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+
+#ifndef streamrestorecache_h
+#define streamrestorecache_h
+
+#include <string>
+
+#include "pavucontrol.h"
+#include <pulse/ext-stream-restore.h>
+
+class MainWindow;
+
+/* Our copy of the stream-restore database. Change notifications only
+ * queue a read, so a burst of them costs one read, and each record that
+ * comes back is compared with the copy so that only entries that really
+ * changed are handed to the main window. */
+class StreamRestoreCache {
+public:
+    StreamRestoreCache(MainWindow *mainWindow);
+    ~StreamRestoreCache();
+
+    /* A read of the whole database has been issued, records are passed to
+     * update() and the read is closed with end() or fail() */
+    void begin();
+    bool update(const pa_ext_stream_restore_info &info);
+    void end();
+    void fail();
+
+    void queueRead();
+    void clear();
+
+    size_t size() const;
+
+private:
+    struct Entry {
+        std::string device;
+        pa_channel_map channelMap;
+        pa_cvolume volume;
+        int mute;
+        unsigned generation;
+    };
+
+    MainWindow *mpMainWindow;
+    std::map<std::string, Entry> entries;
+    unsigned mGeneration;
+    bool reading, dirty;
+
+    sigc::connection readConnection;
+
+    bool onRead();
+    static void read_cb(pa_context *c, const pa_ext_stream_restore_info *i, int eol, void *userdata);
+};
+
+#endif
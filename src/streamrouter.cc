@@ -0,0 +1,178 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+
+#include <string.h>
+
+#include "streamrouter.h"
+
+#include "i18n.h"
+
+#define ROUTE_GROUP_PREFIX "route "
+
+/*** StreamRouter ***/
+StreamRouter::StreamRouter() {
+}
+
+StreamRouter::~StreamRouter() {
+    clear();
+}
+
+void StreamRouter::clear() {
+    for (std::vector<Rule>::iterator i = rules.begin(); i != rules.end(); ++i) {
+        if (i->client)
+            g_pattern_spec_free(i->client);
+
+        for (size_t j = 0; j < i->properties.size(); j++)
+            g_pattern_spec_free(i->properties[j].second);
+    }
+
+    rules.clear();
+    sinkRules.clear();
+    sourceRules.clear();
+    clientMatches.clear();
+}
+
+void StreamRouter::load(GKeyFile *config) {
+    gchar **groups;
+
+    clear();
+
+    /* Groups come in file order, which is the order rules are tried in */
+    groups = g_key_file_get_groups(config, NULL);
+
+    for (gchar **g = groups; *g; g++) {
+        gchar **keys;
+        Rule rule;
+
+        if (!g_str_has_prefix(*g, ROUTE_GROUP_PREFIX))
+            continue;
+
+        if (!(keys = g_key_file_get_keys(config, *g, NULL, NULL)))
+            continue;
+
+        rule.client = NULL;
+
+        for (gchar **k = keys; *k; k++) {
+            gchar *value = g_key_file_get_string(config, *g, *k, NULL);
+
+            if (!value)
+                continue;
+
+            if (strcmp(*k, "sink") == 0)
+                rule.sink = value;
+            else if (strcmp(*k, "source") == 0)
+                rule.source = value;
+            else if (strcmp(*k, "client") == 0) {
+                if (rule.client)
+                    g_pattern_spec_free(rule.client);
+                rule.client = g_pattern_spec_new(value);
+            } else
+                rule.properties.push_back(std::make_pair(std::string(*k), g_pattern_spec_new(value)));
+
+            g_free(value);
+        }
+
+        g_strfreev(keys);
+
+        if (rule.sink.empty() && rule.source.empty()) {
+            g_debug(_("Ignoring routing rule [%s] without a sink or source"), *g);
+
+            if (rule.client)
+                g_pattern_spec_free(rule.client);
+            for (size_t j = 0; j < rule.properties.size(); j++)
+                g_pattern_spec_free(rule.properties[j].second);
+            continue;
+        }
+
+        if (!rule.sink.empty())
+            sinkRules.push_back(rules.size());
+        if (!rule.source.empty())
+            sourceRules.push_back(rules.size());
+        rules.push_back(rule);
+    }
+
+    g_strfreev(groups);
+}
+
+const std::vector<bool>* StreamRouter::matchClient(uint32_t client, const char *clientName) {
+    bool created;
+
+    if (client == PA_INVALID_INDEX || !clientName)
+        return NULL;
+
+    ClientMatch &m = clientMatches.insert(client, &created);
+
+    if (created || m.name != clientName) {
+        m.name = clientName;
+        m.match.resize(rules.size());
+
+        for (size_t i = 0; i < rules.size(); i++)
+            m.match[i] = !rules[i].client || g_pattern_match_string(rules[i].client, clientName);
+    }
+
+    return &m.match;
+}
+
+const char* StreamRouter::route(const std::vector<unsigned> &candidates, bool recording, uint32_t client, const char *clientName, pa_proplist *p) {
+    const std::vector<bool> *clientMatch;
+
+    if (candidates.empty())
+        return NULL;
+
+    clientMatch = matchClient(client, clientName);
+
+    for (std::vector<unsigned>::const_iterator i = candidates.begin(); i != candidates.end(); ++i) {
+        const Rule &rule = rules[*i];
+        size_t j;
+
+        /* Streams without a known client never match client rules */
+        if (rule.client && (!clientMatch || !(*clientMatch)[*i]))
+            continue;
+
+        for (j = 0; j < rule.properties.size(); j++) {
+            const char *v = pa_proplist_gets(p, rule.properties[j].first.c_str());
+
+            if (!v || !g_pattern_match_string(rule.properties[j].second, v))
+                break;
+        }
+
+        if (j == rule.properties.size())
+            return recording ? rule.source.c_str() : rule.sink.c_str();
+    }
+
+    return NULL;
+}
+
+const char* StreamRouter::sinkFor(uint32_t client, const char *clientName, pa_proplist *p) {
+    return route(sinkRules, false, client, clientName, p);
+}
+
+const char* StreamRouter::sourceFor(uint32_t client, const char *clientName, pa_proplist *p) {
+    return route(sourceRules, true, client, clientName, p);
+}
+
+void StreamRouter::removeClient(uint32_t client) {
+    clientMatches.erase(client);
+}
@@ -0,0 +1,78 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+
+#ifndef streamrouter_h
+#define streamrouter_h
+
+#include <string>
+#include <vector>
+
+#include "pavucontrol.h"
+#include "indexmap.h"
+
+/* Moves new streams to the device named by the first matching rule. Rules
+ * are groups in pavucontrol.ini:
+ *
+ *   [route music]
+ *   media.role=music
+ *   client=Spotify*
+ *   sink=alsa_output.usb-Focusrite-00.analog-stereo
+ *
+ * "client" matches the client name, "sink" and "source" name the target
+ * device and every other key is a stream property. Values are glob
+ * patterns, compiled once when the rules are loaded. */
+class StreamRouter {
+public:
+    StreamRouter();
+    ~StreamRouter();
+
+    void load(GKeyFile *config);
+    void clear();
+
+    /* Name of the device the stream belongs on, or NULL */
+    const char* sinkFor(uint32_t client, const char *clientName, pa_proplist *p);
+    const char* sourceFor(uint32_t client, const char *clientName, pa_proplist *p);
+
+    void removeClient(uint32_t client);
+
+private:
+    struct Rule {
+        GPatternSpec *client;
+        std::vector<std::pair<std::string, GPatternSpec*> > properties;
+        std::string sink, source;
+    };
+
+    /* Which rules the client name passes, for the name it was computed
+     * for. Names are interned, so a rename shows as a new pointer. */
+    struct ClientMatch {
+        const char *name;
+        std::vector<bool> match;
+    };
+
+    std::vector<Rule> rules;
+    std::vector<unsigned> sinkRules, sourceRules;
+    IndexMap<ClientMatch> clientMatches;
+
+    const char* route(const std::vector<unsigned> &candidates, bool recording, uint32_t client, const char *clientName, pa_proplist *p);
+    const std::vector<bool>* matchClient(uint32_t client, const char *clientName);
+};
+
+#endif
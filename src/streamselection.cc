@@ -0,0 +1,285 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+
+#include "streamselection.h"
+#include "operationbatch.h"
+#include "mainwindow.h"
+#include "sinkinputwidget.h"
+#include "sourceoutputwidget.h"
+
+#include "i18n.h"
+
+/*** StreamSelection ***/
+StreamSelection::StreamSelection(MainWindow *w, bool recording) :
+    Gtk::HBox(false, 6),
+    mpMainWindow(w),
+    mRecording(recording) {
+
+    muteButton.set_label(_("Mute"));
+    unmuteButton.set_label(_("Unmute"));
+    scaleButton.set_label(_("Scale Volume"));
+    moveButton.set_label(_("Move To..."));
+    killButton.set_label(_("Terminate"));
+    clearButton.set_label(_("Clear Selection"));
+
+    scaleSpinButton.set_digits(0);
+    scaleSpinButton.set_range(0, 200);
+    scaleSpinButton.set_increments(5, 25);
+    scaleSpinButton.set_value(100);
+    scaleSpinButton.set_tooltip_text(_("Percentage of the current volume"));
+
+    muteButton.signal_clicked().connect(sigc::bind(sigc::mem_fun(*this, &StreamSelection::onMute), true));
+    unmuteButton.signal_clicked().connect(sigc::bind(sigc::mem_fun(*this, &StreamSelection::onMute), false));
+    scaleButton.signal_clicked().connect(sigc::mem_fun(*this, &StreamSelection::onScale));
+    moveButton.signal_clicked().connect(sigc::mem_fun(*this, &StreamSelection::onMovePopup));
+    killButton.signal_clicked().connect(sigc::mem_fun(*this, &StreamSelection::onKill));
+    clearButton.signal_clicked().connect(sigc::mem_fun(*this, &StreamSelection::clear));
+
+    countLabel.set_alignment(0, 0.5);
+    pack_start(countLabel, true, true, 0);
+    pack_start(muteButton, false, false, 0);
+    pack_start(unmuteButton, false, false, 0);
+    pack_start(scaleSpinButton, false, false, 0);
+    pack_start(scaleButton, false, false, 0);
+    pack_start(moveButton, false, false, 0);
+    pack_start(killButton, false, false, 0);
+    pack_start(clearButton, false, false, 0);
+    set_border_width(12);
+    show_all_children();
+
+#if !HAVE_SOURCE_OUTPUT_VOLUMES
+    /* Source Outputs do not have volume controls in versions of PA < 1.0 */
+    if (mRecording) {
+        muteButton.hide();
+        unmuteButton.hide();
+        scaleSpinButton.hide();
+        scaleButton.hide();
+    }
+#endif
+
+    update();
+}
+
+void StreamSelection::select(uint32_t index, bool selected) {
+    if (selected)
+        mSelected.insert(index);
+    else
+        mSelected.erase(index);
+
+    update();
+}
+
+void StreamSelection::remove(uint32_t index) {
+    if (mSelected.erase(index))
+        update();
+}
+
+void StreamSelection::clear() {
+    mSelected.clear();
+    updateWidgets();
+    update();
+}
+
+void StreamSelection::update() {
+    gchar *txt;
+
+    if (mSelected.empty()) {
+        hide();
+        return;
+    }
+
+    countLabel.set_markup(txt = g_markup_printf_escaped(_("<b>Selected streams:</b> %u"), (unsigned) mSelected.size()));
+    g_free(txt);
+
+    set_sensitive(mBatches.empty());
+    show();
+}
+
+void StreamSelection::cancel() {
+    for (std::set<OperationBatch*>::iterator i = mBatches.begin(); i != mBatches.end(); ++i)
+        delete *i;
+
+    mBatches.clear();
+    update();
+}
+
+/* Only the rows scrolled into view have a widget to uncheck */
+void StreamSelection::updateWidgets() {
+    if (mRecording) {
+        for (IndexMap<SourceOutputWidget*>::iterator i = mpMainWindow->sourceOutputWidgets.begin(); i != mpMainWindow->sourceOutputWidgets.end(); ++i) {
+            i->second->updating = true;
+            i->second->selectButton.set_active(isSelected(i->first));
+            i->second->updating = false;
+        }
+    } else {
+        for (IndexMap<SinkInputWidget*>::iterator i = mpMainWindow->sinkInputWidgets.begin(); i != mpMainWindow->sinkInputWidgets.end(); ++i) {
+            i->second->updating = true;
+            i->second->selectButton.set_active(isSelected(i->first));
+            i->second->updating = false;
+        }
+    }
+}
+
+OperationBatch* StreamSelection::begin() {
+    OperationBatch *b = new OperationBatch(sigc::mem_fun(*this, &StreamSelection::onBatchDone));
+
+    mBatches.insert(b);
+    return b;
+}
+
+void StreamSelection::end(OperationBatch *b) {
+    update();
+    b->end();
+}
+
+void StreamSelection::onBatchDone(OperationBatch *b) {
+    unsigned operations = b->operations(), failed = b->failed();
+    gchar *txt;
+
+    mBatches.erase(b);
+    update();
+
+    if (failed == 0)
+        return;
+
+    Gtk::MessageDialog dialog(
+        *mpMainWindow,
+        _("Not all selected streams could be changed."),
+        false,
+        Gtk::MESSAGE_WARNING,
+        Gtk::BUTTONS_OK,
+        true);
+    dialog.set_secondary_text(txt = g_strdup_printf(_("%u of %u operations failed, the streams may have gone away."), failed, operations));
+    g_free(txt);
+    dialog.run();
+}
+
+void StreamSelection::onMute(bool mute) {
+    OperationBatch *b = begin();
+
+    mpMainWindow->history.beginGroup();
+    for (std::set<uint32_t>::iterator i = mSelected.begin(); i != mSelected.end(); ++i) {
+        if (mRecording) {
+#if HAVE_SOURCE_OUTPUT_VOLUMES
+            mpMainWindow->fader.cancel(VolumeFader::SOURCE_OUTPUT, *i);
+            mpMainWindow->history.recordMute(UndoHistory::SOURCE_OUTPUT, *i, mute);
+            b->issue(pa_context_set_source_output_mute(get_context(), *i, mute, OperationBatch::success_cb, b->next()));
+#endif
+        } else {
+            mpMainWindow->fader.cancel(VolumeFader::SINK_INPUT, *i);
+            mpMainWindow->history.recordMute(UndoHistory::SINK_INPUT, *i, mute);
+            b->issue(pa_context_set_sink_input_mute(get_context(), *i, mute, OperationBatch::success_cb, b->next()));
+        }
+    }
+    mpMainWindow->history.endGroup();
+
+    end(b);
+}
+
+void StreamSelection::onScale() {
+    double factor = scaleSpinButton.get_value() / 100.0;
+    OperationBatch *b = begin();
+
+    mpMainWindow->history.beginGroup();
+    for (std::set<uint32_t>::iterator i = mSelected.begin(); i != mSelected.end(); ++i) {
+        pa_cvolume volume;
+
+        if (mRecording) {
+#if HAVE_SOURCE_OUTPUT_VOLUMES
+            pa_source_output_info **info = mpMainWindow->sourceOutputInfos.find(*i);
+
+            if (!info)
+                continue;
+            volume = (*info)->volume;
+#else
+            continue;
+#endif
+        } else {
+            pa_sink_input_info **info = mpMainWindow->sinkInputInfos.find(*i);
+
+            if (!info)
+                continue;
+            volume = (*info)->volume;
+        }
+
+        /* Every channel is scaled, so the balance is kept */
+        for (uint8_t c = 0; c < volume.channels; c++) {
+            double v = volume.values[c] * factor;
+            volume.values[c] = v > PA_VOLUME_MAX ? PA_VOLUME_MAX : (pa_volume_t) v;
+        }
+
+        if (mRecording) {
+#if HAVE_SOURCE_OUTPUT_VOLUMES
+            mpMainWindow->fader.cancel(VolumeFader::SOURCE_OUTPUT, *i);
+            mpMainWindow->history.recordVolume(UndoHistory::SOURCE_OUTPUT, *i, volume);
+            b->issue(pa_context_set_source_output_volume(get_context(), *i, &volume, OperationBatch::success_cb, b->next()));
+#endif
+        } else {
+            mpMainWindow->fader.cancel(VolumeFader::SINK_INPUT, *i);
+            mpMainWindow->history.recordVolume(UndoHistory::SINK_INPUT, *i, volume);
+            b->issue(pa_context_set_sink_input_volume(get_context(), *i, &volume, OperationBatch::success_cb, b->next()));
+        }
+    }
+    mpMainWindow->history.endGroup();
+
+    end(b);
+}
+
+void StreamSelection::onMovePopup() {
+    DeviceMenu &menu = mRecording ? mpMainWindow->sourceMenu : mpMainWindow->sinkMenu;
+
+    menu.popup(PA_INVALID_INDEX, sigc::mem_fun(*this, &StreamSelection::onMove));
+}
+
+void StreamSelection::onMove(uint32_t device) {
+    OperationBatch *b = begin();
+
+    mpMainWindow->history.beginGroup();
+    for (std::set<uint32_t>::iterator i = mSelected.begin(); i != mSelected.end(); ++i) {
+        mpMainWindow->history.recordMove(mRecording ? UndoHistory::SOURCE_OUTPUT : UndoHistory::SINK_INPUT, *i, device);
+
+        if (mRecording)
+            b->issue(pa_context_move_source_output_by_index(get_context(), *i, device, OperationBatch::success_cb, b->next()));
+        else
+            b->issue(pa_context_move_sink_input_by_index(get_context(), *i, device, OperationBatch::success_cb, b->next()));
+    }
+    mpMainWindow->history.endGroup();
+
+    end(b);
+}
+
+void StreamSelection::onKill() {
+    OperationBatch *b = begin();
+
+    /* The streams leave the selection as the server removes them */
+    for (std::set<uint32_t>::iterator i = mSelected.begin(); i != mSelected.end(); ++i) {
+        if (mRecording)
+            b->issue(pa_context_kill_source_output(get_context(), *i, OperationBatch::success_cb, b->next()));
+        else
+            b->issue(pa_context_kill_sink_input(get_context(), *i, OperationBatch::success_cb, b->next()));
+    }
+
+    end(b);
+}
@@ -0,0 +1,73 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+
+#ifndef streamselection_h
+#define streamselection_h
+
+#include <set>
+
+#include "pavucontrol.h"
+
+class MainWindow;
+class OperationBatch;
+
+/* The streams selected on the playback or recording page and the bar
+ * with the actions for all of them. Selection is kept by stream index, so
+ * it survives the widgets being recycled. Each action sends its
+ * operations back to back and the bar waits for all of them. */
+class StreamSelection : public Gtk::HBox {
+public:
+    StreamSelection(MainWindow *w, bool recording);
+
+    bool isSelected(uint32_t index) const { return mSelected.count(index) > 0; }
+    void select(uint32_t index, bool selected);
+    void remove(uint32_t index);
+    void clear();
+
+    /* The connection is gone and with it the callbacks of the operations
+     * still pending, forget about them */
+    void cancel();
+
+private:
+    MainWindow *mpMainWindow;
+    bool mRecording;
+    std::set<uint32_t> mSelected;
+    std::set<OperationBatch*> mBatches;
+
+    Gtk::Label countLabel;
+    Gtk::Button muteButton, unmuteButton, scaleButton, moveButton, killButton, clearButton;
+    Gtk::SpinButton scaleSpinButton;
+
+    void update();
+    void updateWidgets();
+
+    void onMute(bool mute);
+    void onScale();
+    void onMovePopup();
+    void onMove(uint32_t device);
+    void onKill();
+
+    OperationBatch* begin();
+    void end(OperationBatch *b);
+    void onBatchDone(OperationBatch *b);
+};
+
+#endif
@@ -25,14 +25,16 @@
 #include "streamwidget.h"
 #include "mainwindow.h"
 #include "channelwidget.h"
+#include "resamplesummary.h"
 
 #include "i18n.h"
 
 /*** StreamWidget ***/
 StreamWidget::StreamWidget(BaseObjectType* cobject, const Glib::RefPtr<Gtk::Builder>& x) :
     MinimalStreamWidget(cobject, x),
-    peak(NULL),
-    mpMainWindow(NULL) {
+    allChannelsWidget(NULL),
+    mpMainWindow(NULL),
+    canDecibel(false) {
 
     x->get_widget("lockToggleButton", lockToggleButton);
     x->get_widget("muteToggleButton", muteToggleButton);
@@ -41,11 +43,30 @@ StreamWidget::StreamWidget(BaseObjectType* cobject, const Glib::RefPtr<Gtk::Buil
 
     this->signal_button_press_event().connect(sigc::mem_fun(*this, &StreamWidget::onContextTriggerEvent));
     muteToggleButton->signal_clicked().connect(sigc::mem_fun(*this, &StreamWidget::onMuteToggleButton));
+    lockToggleButton->signal_toggled().connect(sigc::mem_fun(*this, &StreamWidget::onLockToggleButton));
     deviceButton->signal_clicked().connect(sigc::mem_fun(*this, &StreamWidget::onDeviceChangePopup));
 
+    Gtk::HBox *titleHBox;
+    x->get_widget("hbox1", titleHBox);
+    titleHBox->pack_start(selectButton, false, false, 0);
+    titleHBox->reorder_child(selectButton, 0);
+    selectButton.set_tooltip_text(_("Select for actions on several streams"));
+    selectButton.signal_toggled().connect(sigc::mem_fun(*this, &StreamWidget::onSelectToggled));
+    selectButton.show();
+
+    /* Shown once the stream has told its sample spec */
+    Gtk::VBox *streamVBox;
+    x->get_widget("vbox26", streamVBox);
+    streamVBox->pack_start(formatLabel, false, false, 0);
+    streamVBox->reorder_child(formatLabel, 1);
+    formatLabel.set_alignment(0, 0.5);
+
     terminate.set_label(_("Terminate"));
     terminate.signal_activate().connect(sigc::mem_fun(*this, &StreamWidget::onKill));
     contextMenu.append(terminate);
+    saveClipLog.set_label(_("Save Clip Log..."));
+    saveClipLog.signal_activate().connect(sigc::mem_fun(*this, &StreamWidget::onSaveClipLog));
+    contextMenu.append(saveClipLog);
     contextMenu.show_all();
 
     for (unsigned i = 0; i < PA_CHANNELS_MAX; i++)
@@ -57,6 +78,28 @@ void StreamWidget::init(MainWindow* mainWindow) {
     mpMainWindow = mainWindow;
 }
 
+void StreamWidget::setFormat(const pa_sample_spec &stream, const pa_sample_spec *device, const char *method) {
+    char s[PA_SAMPLE_SPEC_SNPRINT_MAX], d[PA_SAMPLE_SPEC_SNPRINT_MAX];
+    gchar *txt;
+
+    pa_sample_spec_snprint(s, sizeof(s), &stream);
+    if (device)
+        pa_sample_spec_snprint(d, sizeof(d), device);
+    else
+        g_strlcpy(d, _("unknown"), sizeof(d));
+
+    formatLabel.set_markup(txt = g_markup_printf_escaped(_("<small>Stream: %s, device: %s, resampler: %s</small>"), s, d, method ? method : _("none")));
+    g_free(txt);
+
+    if (device && method) {
+        formatLabel.set_tooltip_text(txt = g_strdup_printf(_("Estimated resampling cost: %.1f"), ResampleSummary::cost(stream, *device, method)));
+        g_free(txt);
+    } else
+        formatLabel.set_tooltip_text("");
+
+    formatLabel.show();
+}
+
 bool StreamWidget::onContextTriggerEvent(GdkEventButton* event) {
     if (GDK_BUTTON_PRESS == event->type && 3 == event->button) {
         contextMenu.popup(event->button, event->time);
@@ -65,23 +108,82 @@ bool StreamWidget::onContextTriggerEvent(GdkEventButton* event) {
     return false;
 }
 
+ChannelWidget* StreamWidget::createChannelWidget(int channel, const char *label, bool last) {
+    ChannelWidget *cw = ChannelWidget::create();
+    char text[64];
+
+    cw->channel = channel;
+    cw->can_decibel = canDecibel;
+    cw->minimalStreamWidget = this;
+    cw->last = last;
+    snprintf(text, sizeof(text), "<b>%s</b>", label);
+    cw->channelLabel->set_markup(text);
+    cw->setBaseVolume(PA_VOLUME_NORM);
+    cw->set_sensitive(!muteToggleButton->get_active());
+    channelsVBox->pack_start(*cw, false, false, 0);
+
+    return cw;
+}
+
 void StreamWidget::setChannelMap(const pa_channel_map &m, bool can_decibel) {
+
+    /* A recycled widget may have been unlocked for its previous stream */
+    if (!lockToggleButton->get_active())
+        lockToggleButton->set_active(true);
+
     channelMap = m;
+    canDecibel = can_decibel;
+    pa_cvolume_reset(&volume, m.channels);
+
+    /* Recycled widgets get the channels of their new stream */
+    delete allChannelsWidget;
+    allChannelsWidget = NULL;
 
-    for (int i = 0; i < m.channels; i++) {
-        ChannelWidget *cw = channelWidgets[i] = ChannelWidget::create();
-        cw->channel = i;
-        cw->can_decibel = can_decibel;
-        cw->minimalStreamWidget = this;
-        char text[64];
-        snprintf(text, sizeof(text), "<b>%s</b>", pa_channel_position_to_pretty_string(m.map[i]));
-        cw->channelLabel->set_markup(text);
-        channelsVBox->pack_start(*cw, false, false, 0);
+    for (int i = 0; i < PA_CHANNELS_MAX; i++) {
+        delete channelWidgets[i];
+        channelWidgets[i] = NULL;
     }
-    channelWidgets[m.channels-1]->last = true;
-    channelWidgets[m.channels-1]->setBaseVolume(PA_VOLUME_NORM);
+
+    /* Locked channels all move together, so they get a single slider until
+     * the user unlocks them */
+    if (m.channels > 1)
+        allChannelsWidget = createChannelWidget(0, _("All Channels"), true);
 
     lockToggleButton->set_sensitive(m.channels > 1);
+
+    updateChannelView();
+}
+
+void StreamWidget::updateChannelView() {
+    bool collapsed = allChannelsWidget && lockToggleButton->get_active();
+
+    if (!collapsed && !channelWidgets[0]) {
+        for (int i = 0; i < channelMap.channels; i++) {
+            channelWidgets[i] = createChannelWidget(i, pa_channel_position_to_pretty_string(channelMap.map[i]), i == channelMap.channels - 1);
+            channelWidgets[i]->setVolume(volume.values[i]);
+        }
+    }
+
+    if (allChannelsWidget) {
+        if (collapsed)
+            allChannelsWidget->show();
+        else
+            allChannelsWidget->hide();
+    }
+
+    for (int i = 0; i < channelMap.channels; i++) {
+        if (!channelWidgets[i])
+            continue;
+
+        if (collapsed)
+            channelWidgets[i]->hide();
+        else
+            channelWidgets[i]->show();
+    }
+}
+
+void StreamWidget::onLockToggleButton() {
+    updateChannelView();
 }
 
 void StreamWidget::setVolume(const pa_cvolume &v, bool force) {
@@ -90,8 +192,12 @@ void StreamWidget::setVolume(const pa_cvolume &v, bool force) {
     volume = v;
 
     if (timeoutConnection.empty() || force) { /* do not update the volume when a volume change is still in flux */
+        if (allChannelsWidget)
+            allChannelsWidget->setVolume(pa_cvolume_max(&volume));
+
         for (int i = 0; i < volume.channels; i++)
-            channelWidgets[i]->setVolume(volume.values[i]);
+            if (channelWidgets[i])
+                channelWidgets[i]->setVolume(volume.values[i]);
     }
 }
 
@@ -116,8 +222,12 @@ void StreamWidget::onMuteToggleButton() {
 
     lockToggleButton->set_sensitive(!muteToggleButton->get_active());
 
+    if (allChannelsWidget)
+        allChannelsWidget->set_sensitive(!muteToggleButton->get_active());
+
     for (int i = 0; i < channelMap.channels; i++)
-        channelWidgets[i]->set_sensitive(!muteToggleButton->get_active());
+        if (channelWidgets[i])
+            channelWidgets[i]->set_sensitive(!muteToggleButton->get_active());
 }
 
 bool StreamWidget::timeoutEvent() {
@@ -125,11 +235,26 @@ bool StreamWidget::timeoutEvent() {
     return false;
 }
 
+void StreamWidget::flushVolumeUpdate() {
+    if (!timeoutConnection.connected())
+        return;
+
+    timeoutConnection.disconnect();
+    executeVolumeUpdate();
+}
+
 void StreamWidget::executeVolumeUpdate() {
 }
 
 void StreamWidget::onDeviceChangePopup() {
 }
 
+void StreamWidget::onSelectToggled() {
+}
+
 void StreamWidget::onKill() {
 }
+
+void StreamWidget::onSaveClipLog() {
+    mpMainWindow->saveClipLog();
+}
@@ -35,34 +35,48 @@ public:
 
     void setChannelMap(const pa_channel_map &m, bool can_decibel);
     void setVolume(const pa_cvolume &volume, bool force = false);
+    void setFormat(const pa_sample_spec &stream, const pa_sample_spec *device, const char *method);
     virtual void updateChannelVolume(int channel, pa_volume_t v);
 
     Gtk::ToggleButton *lockToggleButton, *muteToggleButton;
     Gtk::Label *directionLabel;
     Gtk::Button *deviceButton;
+    Gtk::CheckButton selectButton;
+    Gtk::Label formatLabel;
 
     pa_channel_map channelMap;
     pa_cvolume volume;
-    pa_stream *peak;
 
     ChannelWidget *channelWidgets[PA_CHANNELS_MAX];
+    ChannelWidget *allChannelsWidget;
 
     virtual void onMuteToggleButton();
+    virtual void onLockToggleButton();
     virtual void onDeviceChangePopup();
+    virtual void onSelectToggled();
     virtual bool onContextTriggerEvent(GdkEventButton*);
 
     sigc::connection timeoutConnection;
 
     bool timeoutEvent();
+    void flushVolumeUpdate();
+    void updateChannelView();
 
     virtual void executeVolumeUpdate();
     virtual void onKill();
+    void onSaveClipLog();
 
 protected:
     MainWindow* mpMainWindow;
 
     Gtk::Menu contextMenu;
     Gtk::MenuItem terminate;
+    Gtk::MenuItem saveClipLog;
+
+private:
+    bool canDecibel;
+
+    ChannelWidget* createChannelWidget(int channel, const char *label, bool last);
 };
 
 #endif
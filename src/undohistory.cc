@@ -0,0 +1,386 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+
+#include "undohistory.h"
+#include "mainwindow.h"
+#include "operationbatch.h"
+
+#include "i18n.h"
+
+/* Older entries are forgotten */
+#define UNDO_MAX_ENTRIES 100
+
+/* Volume steps closer together than this are one drag */
+#define UNDO_MERGE_USEC (1000*1000)
+
+static const char* device_name(MainWindow *w, UndoHistory::Object object, uint32_t index) {
+    if (object == UndoHistory::SINK) {
+        pa_sink_info **i = w->sinkInfos.find(index);
+        return i ? (*i)->name : NULL;
+    }
+
+    pa_source_info **i = w->sourceInfos.find(index);
+    return i ? (*i)->name : NULL;
+}
+
+/*** UndoHistory ***/
+UndoHistory::UndoHistory(MainWindow *w) :
+    mpMainWindow(w),
+    mGroup(0),
+    mGroupStarted(false),
+    mLastRecord(0) {
+}
+
+UndoHistory::~UndoHistory() {
+}
+
+/* Fills in what the window knows about the object now as the state
+ * before the change */
+bool UndoHistory::lookup(Object object, uint32_t index, Change *c) {
+    c->object = object;
+    c->index = index;
+
+    switch (object) {
+        case SINK: {
+            pa_sink_info **i = mpMainWindow->sinkInfos.find(index);
+            if (!i)
+                return false;
+            c->name = (*i)->name;
+            c->volume[0] = (*i)->volume;
+            c->mute[0] = (*i)->mute;
+            c->value[0] = (*i)->active_port ? (*i)->active_port->name : "";
+            return true;
+        }
+        case SOURCE: {
+            pa_source_info **i = mpMainWindow->sourceInfos.find(index);
+            if (!i)
+                return false;
+            c->name = (*i)->name;
+            c->volume[0] = (*i)->volume;
+            c->mute[0] = (*i)->mute;
+            c->value[0] = (*i)->active_port ? (*i)->active_port->name : "";
+            return true;
+        }
+        case SINK_INPUT: {
+            pa_sink_input_info **i = mpMainWindow->sinkInputInfos.find(index);
+            const char *device;
+            if (!i)
+                return false;
+            c->volume[0] = (*i)->volume;
+            c->mute[0] = (*i)->mute;
+            device = device_name(mpMainWindow, SINK, (*i)->sink);
+            c->value[0] = device ? device : "";
+            return true;
+        }
+        case SOURCE_OUTPUT: {
+            pa_source_output_info **i = mpMainWindow->sourceOutputInfos.find(index);
+            const char *device;
+            if (!i)
+                return false;
+#if HAVE_SOURCE_OUTPUT_VOLUMES
+            c->volume[0] = (*i)->volume;
+            c->mute[0] = (*i)->mute;
+#endif
+            device = device_name(mpMainWindow, SOURCE, (*i)->source);
+            c->value[0] = device ? device : "";
+            return true;
+        }
+        case CARD: {
+            pa_card_info **i = mpMainWindow->cardInfos.find(index);
+            if (!i)
+                return false;
+            c->name = (*i)->name;
+            c->value[0] = (*i)->active_profile ? (*i)->active_profile->name : "";
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void UndoHistory::record(const Change &c) {
+    gint64 now = g_get_monotonic_time();
+
+    undone.clear();
+
+    if (mGroup > 0 && mGroupStarted)
+        done.back().push_back(c);
+    else if (mGroup == 0 && c.kind == VOLUME && !done.empty() && done.back().size() == 1 &&
+             now - mLastRecord < UNDO_MERGE_USEC) {
+        Change &last = done.back()[0];
+
+        /* Still the same drag, it keeps the volume from before it */
+        if (last.kind == VOLUME && last.object == c.object && last.index == c.index && last.name == c.name)
+            last.volume[1] = c.volume[1];
+        else
+            done.push_back(Entry(1, c));
+    } else {
+        done.push_back(Entry(1, c));
+        mGroupStarted = mGroup > 0;
+    }
+
+    while (done.size() > UNDO_MAX_ENTRIES)
+        done.pop_front();
+
+    mLastRecord = now;
+}
+
+void UndoHistory::recordVolume(Object object, uint32_t index, const pa_cvolume &volume) {
+    Change c;
+
+    if (!lookup(object, index, &c) || pa_cvolume_equal(&c.volume[0], &volume))
+        return;
+
+    c.kind = VOLUME;
+    c.volume[1] = volume;
+    record(c);
+}
+
+void UndoHistory::recordMute(Object object, uint32_t index, bool mute) {
+    Change c;
+
+    if (!lookup(object, index, &c) || c.mute[0] == mute)
+        return;
+
+    c.kind = MUTE;
+    c.mute[1] = mute;
+    record(c);
+}
+
+void UndoHistory::recordPort(Object object, uint32_t index, const char *port) {
+    Change c;
+
+    if (!lookup(object, index, &c) || c.value[0].empty() || c.value[0] == port)
+        return;
+
+    c.kind = PORT;
+    c.value[1] = port;
+    record(c);
+}
+
+void UndoHistory::recordProfile(uint32_t card, const char *profile) {
+    Change c;
+
+    if (!lookup(CARD, card, &c) || c.value[0].empty() || c.value[0] == profile)
+        return;
+
+    c.kind = PROFILE;
+    c.value[1] = profile;
+    record(c);
+}
+
+void UndoHistory::recordMove(Object object, uint32_t stream, uint32_t device) {
+    const char *name;
+    Change c;
+
+    if (!lookup(object, stream, &c) || c.value[0].empty())
+        return;
+
+    if (!(name = device_name(mpMainWindow, object == SINK_INPUT ? SINK : SOURCE, device)) || c.value[0] == name)
+        return;
+
+    c.kind = MOVE;
+    c.value[1] = name;
+    record(c);
+}
+
+void UndoHistory::recordDefault(Object object, const char *name) {
+    GQuark current = object == SINK ? mpMainWindow->defaultSinkName : mpMainWindow->defaultSourceName;
+    Change c;
+
+    /* There is nothing to go back to without a default */
+    if (!current || strcmp(g_quark_to_string(current), name) == 0)
+        return;
+
+    c.kind = DEFAULT;
+    c.object = object;
+    c.value[0] = g_quark_to_string(current);
+    c.value[1] = name;
+    record(c);
+}
+
+void UndoHistory::beginGroup() {
+    if (mGroup++ == 0)
+        mGroupStarted = false;
+}
+
+void UndoHistory::endGroup() {
+    g_assert(mGroup > 0);
+
+    if (--mGroup == 0)
+        mGroupStarted = false;
+}
+
+bool UndoHistory::undo() {
+    pa_context *c = get_context();
+
+    if (done.empty() || !c || pa_context_get_state(c) != PA_CONTEXT_READY)
+        return false;
+
+    undone.push_back(done.back());
+    done.pop_back();
+    mLastRecord = 0;
+
+    replay(undone.back(), true);
+    return true;
+}
+
+bool UndoHistory::redo() {
+    pa_context *c = get_context();
+
+    if (undone.empty() || !c || pa_context_get_state(c) != PA_CONTEXT_READY)
+        return false;
+
+    done.push_back(undone.back());
+    undone.pop_back();
+    mLastRecord = 0;
+
+    replay(done.back(), false);
+    return true;
+}
+
+void UndoHistory::clear() {
+    done.clear();
+    undone.clear();
+    mLastRecord = 0;
+
+    for (std::set<OperationBatch*>::iterator i = replays.begin(); i != replays.end(); ++i)
+        delete *i;
+    replays.clear();
+}
+
+/* Sent back to back like a snapshot restore, undoing goes through the
+ * changes of a group backwards */
+void UndoHistory::replay(const Entry &e, bool undo) {
+    OperationBatch *b = new OperationBatch(sigc::bind(sigc::mem_fun(*this, &UndoHistory::onReplayDone), undo));
+
+    replays.insert(b);
+
+    if (undo)
+        for (size_t i = e.size(); i-- > 0;)
+            b->issue(apply(b, e[i], 0));
+    else
+        for (size_t i = 0; i < e.size(); i++)
+            b->issue(apply(b, e[i], 1));
+
+    b->end();
+}
+
+pa_operation* UndoHistory::apply(OperationBatch *b, const Change &c, int state) {
+    static const VolumeFader::Kind kinds[] = {
+        VolumeFader::SINK, VolumeFader::SOURCE, VolumeFader::SINK_INPUT, VolumeFader::SOURCE_OUTPUT
+    };
+    pa_context *ctx = get_context();
+    const char *name = c.name.c_str(), *value = c.value[state].c_str();
+
+    /* A fade still running would take the volume away again */
+    if (c.kind == VOLUME || c.kind == MUTE) {
+        uint32_t index = c.index;
+        GQuark q;
+        uint32_t *i;
+
+        if (c.object == SINK || c.object == SOURCE) {
+            IndexMap<uint32_t> &byName = c.object == SINK ? mpMainWindow->sinksByName : mpMainWindow->sourcesByName;
+            index = (q = g_quark_try_string(name)) && (i = byName.find(q)) ? *i : PA_INVALID_INDEX;
+        }
+
+        if (index != PA_INVALID_INDEX)
+            mpMainWindow->fader.cancel(kinds[c.object], index);
+    }
+
+    switch (c.kind) {
+        case VOLUME:
+            switch (c.object) {
+                case SINK:
+                    return pa_context_set_sink_volume_by_name(ctx, name, &c.volume[state], OperationBatch::success_cb, b->next());
+                case SOURCE:
+                    return pa_context_set_source_volume_by_name(ctx, name, &c.volume[state], OperationBatch::success_cb, b->next());
+                case SINK_INPUT:
+                    return pa_context_set_sink_input_volume(ctx, c.index, &c.volume[state], OperationBatch::success_cb, b->next());
+#if HAVE_SOURCE_OUTPUT_VOLUMES
+                case SOURCE_OUTPUT:
+                    return pa_context_set_source_output_volume(ctx, c.index, &c.volume[state], OperationBatch::success_cb, b->next());
+#endif
+                default:
+                    return NULL;
+            }
+
+        case MUTE:
+            switch (c.object) {
+                case SINK:
+                    return pa_context_set_sink_mute_by_name(ctx, name, c.mute[state], OperationBatch::success_cb, b->next());
+                case SOURCE:
+                    return pa_context_set_source_mute_by_name(ctx, name, c.mute[state], OperationBatch::success_cb, b->next());
+                case SINK_INPUT:
+                    return pa_context_set_sink_input_mute(ctx, c.index, c.mute[state], OperationBatch::success_cb, b->next());
+#if HAVE_SOURCE_OUTPUT_VOLUMES
+                case SOURCE_OUTPUT:
+                    return pa_context_set_source_output_mute(ctx, c.index, c.mute[state], OperationBatch::success_cb, b->next());
+#endif
+                default:
+                    return NULL;
+            }
+
+        case PORT:
+            if (c.object == SINK)
+                return pa_context_set_sink_port_by_name(ctx, name, value, OperationBatch::success_cb, b->next());
+            return pa_context_set_source_port_by_name(ctx, name, value, OperationBatch::success_cb, b->next());
+
+        case PROFILE:
+            return pa_context_set_card_profile_by_name(ctx, name, value, OperationBatch::success_cb, b->next());
+
+        case MOVE:
+            if (c.object == SINK_INPUT)
+                return pa_context_move_sink_input_by_name(ctx, c.index, value, OperationBatch::success_cb, b->next());
+            return pa_context_move_source_output_by_name(ctx, c.index, value, OperationBatch::success_cb, b->next());
+
+        case DEFAULT:
+            if (c.object == SINK)
+                return pa_context_set_default_sink(ctx, value, OperationBatch::success_cb, b->next());
+            return pa_context_set_default_source(ctx, value, OperationBatch::success_cb, b->next());
+    }
+
+    return NULL;
+}
+
+void UndoHistory::onReplayDone(OperationBatch *b, bool undo) {
+    gchar *txt;
+
+    replays.erase(b);
+
+    if (b->failed() == 0)
+        return;
+
+    Gtk::MessageDialog dialog(
+        *mpMainWindow,
+        undo ? _("The change was only partly undone.") : _("The change was only partly redone."),
+        false,
+        Gtk::MESSAGE_WARNING,
+        Gtk::BUTTONS_OK,
+        true);
+    dialog.set_secondary_text(txt = g_strdup_printf(_("%u of %u changes could not be made, the devices or streams they were for may have gone away."), b->failed(), b->operations()));
+    g_free(txt);
+    dialog.run();
+}
@@ -0,0 +1,119 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+
+#ifndef undohistory_h
+#define undohistory_h
+
+#include <set>
+#include <string>
+#include <vector>
+#include <deque>
+
+#include "pavucontrol.h"
+
+class MainWindow;
+class OperationBatch;
+
+/* The changes made from the window, most recent last, for Ctrl+Z and
+ * Ctrl+Shift+Z. Devices and cards are remembered by name so that an undo
+ * still finds them after they were recreated, streams by index. The
+ * steps of one slider drag are merged into a single entry. */
+class UndoHistory {
+public:
+    enum Object {
+        SINK,
+        SOURCE,
+        SINK_INPUT,
+        SOURCE_OUTPUT,
+        CARD
+    };
+
+    UndoHistory(MainWindow *w);
+    ~UndoHistory();
+
+    /* Called before the operation is sent, while the window still knows
+     * the state it replaces */
+    void recordVolume(Object object, uint32_t index, const pa_cvolume &volume);
+    void recordMute(Object object, uint32_t index, bool mute);
+    void recordPort(Object object, uint32_t index, const char *port);
+    void recordProfile(uint32_t card, const char *profile);
+    void recordMove(Object object, uint32_t stream, uint32_t device);
+    void recordDefault(Object object, const char *name);
+
+    /* Everything recorded in between is undone in one step */
+    void beginGroup();
+    void endGroup();
+
+    bool canUndo() const { return !done.empty(); }
+    bool canRedo() const { return !undone.empty(); }
+    bool undo();
+    bool redo();
+
+    /* Stream indexes mean nothing on another connection, and the replays
+     * still in progress will not get an answer from this one */
+    void clear();
+
+private:
+    enum Kind {
+        VOLUME,
+        MUTE,
+        PORT,
+        PROFILE,
+        MOVE,
+        DEFAULT
+    };
+
+    /* [0] is the state before the change, [1] the one after it */
+    struct Change {
+        Kind kind;
+        Object object;
+        uint32_t index;
+        std::string name;
+        pa_cvolume volume[2];
+        bool mute[2];
+        std::string value[2];
+
+        Change() : index(PA_INVALID_INDEX) {
+            mute[0] = mute[1] = false;
+            pa_cvolume_init(&volume[0]);
+            pa_cvolume_init(&volume[1]);
+        }
+    };
+
+    typedef std::vector<Change> Entry;
+
+    MainWindow *mpMainWindow;
+    std::deque<Entry> done;
+    std::vector<Entry> undone;
+    std::set<OperationBatch*> replays;
+    unsigned mGroup;
+    bool mGroupStarted;
+    gint64 mLastRecord;
+
+    bool lookup(Object object, uint32_t index, Change *c);
+    void record(const Change &c);
+
+    void replay(const Entry &e, bool undo);
+    pa_operation* apply(OperationBatch *b, const Change &c, int state);
+    void onReplayDone(OperationBatch *b, bool undo);
+};
+
+#endif
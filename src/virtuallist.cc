@@ -0,0 +1,128 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <algorithm>
+
+#include "virtuallist.h"
+
+/*** VirtualList ***/
+VirtualList::VirtualList(Gtk::ScrolledWindow *scrolledWindow, const sigc::slot<void, unsigned, unsigned> &bind) :
+    mpScrolledWindow(scrolledWindow),
+    mBind(bind),
+    mRows(0),
+    mFirst(0),
+    mLast(0),
+    mRowHeight(0),
+    mDirty(false) {
+
+    pack_start(topSpacer, false, false, 0);
+    pack_start(bottomSpacer, false, false, 0);
+    topSpacer.show();
+    bottomSpacer.show();
+
+    mpScrolledWindow->get_vadjustment()->signal_value_changed().connect(sigc::mem_fun(*this, &VirtualList::queueUpdate));
+    mpScrolledWindow->get_vadjustment()->signal_changed().connect(sigc::mem_fun(*this, &VirtualList::queueUpdate));
+}
+
+VirtualList::~VirtualList() {
+    idleConnection.disconnect();
+}
+
+void VirtualList::setRowCount(unsigned n) {
+    mRows = n;
+
+    /* The rows behind the indexes may have changed too */
+    mDirty = true;
+    queueUpdate();
+}
+
+void VirtualList::placeRow(Gtk::Widget &w, unsigned row) {
+    g_assert(row >= mFirst && row < mLast);
+
+    reorder_child(w, 1 + (row - mFirst));
+}
+
+void VirtualList::queueUpdate() {
+    if (idleConnection.connected())
+        return;
+
+    idleConnection = Glib::signal_idle().connect(sigc::mem_fun(*this, &VirtualList::onIdle));
+}
+
+bool VirtualList::onIdle() {
+    update();
+    return false;
+}
+
+void VirtualList::measureRowHeight() {
+    std::vector<Gtk::Widget*> children = get_children();
+    int total = 0, n = 0;
+
+    for (std::vector<Gtk::Widget*>::iterator i = children.begin(); i != children.end(); ++i) {
+        if (*i == &topSpacer || *i == &bottomSpacer || !(*i)->get_mapped())
+            continue;
+
+        total += (*i)->get_allocation().get_height();
+        n++;
+    }
+
+    /* Keep the last measurement while we are not on screen */
+    if (n > 0 && total > n)
+        mRowHeight = total / n;
+}
+
+void VirtualList::update() {
+    unsigned first, last;
+
+    measureRowHeight();
+
+    if (mRowHeight <= 0) {
+        first = 0;
+        last = std::min(mRows, (unsigned) VIRTUAL_LIST_INITIAL_ROWS);
+    } else {
+        double top = mpScrolledWindow->get_vadjustment()->get_value() - get_allocation().get_y();
+        double bottom = top + mpScrolledWindow->get_vadjustment()->get_page_size();
+
+        first = top > 0 ? (unsigned) (top / mRowHeight) : 0;
+        first = first > VIRTUAL_LIST_OVERSCAN ? first - VIRTUAL_LIST_OVERSCAN : 0;
+        last = bottom > 0 ? (unsigned) (bottom / mRowHeight) + 1 + VIRTUAL_LIST_OVERSCAN : 0;
+
+        last = std::min(last, mRows);
+        first = std::min(first, last);
+    }
+
+    if (!mDirty && first == mFirst && last == mLast)
+        return;
+
+    mFirst = first;
+    mLast = last;
+    mDirty = false;
+
+    topSpacer.set_size_request(-1, mFirst * mRowHeight);
+    bottomSpacer.set_size_request(-1, (mRows - mLast) * mRowHeight);
+
+    mBind(mFirst, mLast);
+
+    reorder_child(bottomSpacer, -1);
+}
@@ -0,0 +1,61 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+#ifndef virtuallist_h
+#define virtuallist_h
+
+#include "pavucontrol.h"
+
+/* Rows realized before we know how tall a row is */
+#define VIRTUAL_LIST_INITIAL_ROWS 32
+
+/* Rows realized above and below the viewport */
+#define VIRTUAL_LIST_OVERSCAN 4
+
+/* A box that only holds widgets for the rows that are scrolled into view,
+ * with spacers standing in for the rest. Whenever the visible range
+ * changes the bind slot is called with [first, last) and is expected to
+ * hand one widget per row to placeRow(). */
+class VirtualList : public Gtk::VBox {
+public:
+    VirtualList(Gtk::ScrolledWindow *scrolledWindow, const sigc::slot<void, unsigned, unsigned> &bind);
+    virtual ~VirtualList();
+
+    void setRowCount(unsigned n);
+    void placeRow(Gtk::Widget &w, unsigned row);
+
+private:
+    Gtk::ScrolledWindow *mpScrolledWindow;
+    sigc::slot<void, unsigned, unsigned> mBind;
+    Gtk::Alignment topSpacer, bottomSpacer;
+
+    unsigned mRows, mFirst, mLast;
+    int mRowHeight;
+    bool mDirty;
+
+    sigc::connection idleConnection;
+
+    void queueUpdate();
+    bool onIdle();
+    void update();
+    void measureRowHeight();
+};
+
+#endif
@@ -0,0 +1,388 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+
+#include <math.h>
+
+#include <pulse/ext-stream-restore.h>
+
+#include "volumefader.h"
+#include "mainwindow.h"
+#include "rolewidget.h"
+
+/* Ticks per second bound the operations per object and second */
+#define FADE_INTERVAL_MSEC 40
+
+/* Silence is faded to and from this level, not from -inf dB */
+#define FADE_FLOOR_DB (-60.0)
+
+static double fade_db(pa_volume_t v) {
+    double db = pa_sw_volume_to_dB(v);
+
+    return db < FADE_FLOOR_DB ? FADE_FLOOR_DB : db;
+}
+
+/*** VolumeFader ***/
+VolumeFader::VolumeFader(MainWindow *w) :
+    mpMainWindow(w),
+    mMuteDuration(0) {
+}
+
+VolumeFader::~VolumeFader() {
+    timerConnection.disconnect();
+    clear();
+}
+
+bool VolumeFader::current(Kind kind, uint32_t index, pa_cvolume *volume) {
+    switch (kind) {
+        case SINK: {
+            pa_sink_info **i = mpMainWindow->sinkInfos.find(index);
+            if (!i)
+                return false;
+            *volume = (*i)->volume;
+            return true;
+        }
+        case SOURCE: {
+            pa_source_info **i = mpMainWindow->sourceInfos.find(index);
+            if (!i)
+                return false;
+            *volume = (*i)->volume;
+            return true;
+        }
+        case SINK_INPUT: {
+            pa_sink_input_info **i = mpMainWindow->sinkInputInfos.find(index);
+            if (!i)
+                return false;
+            *volume = (*i)->volume;
+            return true;
+        }
+        case SOURCE_OUTPUT: {
+#if HAVE_SOURCE_OUTPUT_VOLUMES
+            pa_source_output_info **i = mpMainWindow->sourceOutputInfos.find(index);
+            if (!i)
+                return false;
+            *volume = (*i)->volume;
+            return true;
+#else
+            return false;
+#endif
+        }
+        case EVENT_ROLE:
+            if (!mpMainWindow->eventRoleWidget)
+                return false;
+            *volume = mpMainWindow->eventRoleWidget->volume;
+            return true;
+    }
+
+    return false;
+}
+
+pa_operation* VolumeFader::setVolume(Kind kind, uint32_t index, const pa_cvolume &volume, bool mute, pa_context_success_cb_t cb, void *userdata) {
+    switch (kind) {
+        case SINK:
+            return pa_context_set_sink_volume_by_index(get_context(), index, &volume, cb, userdata);
+        case SOURCE:
+            return pa_context_set_source_volume_by_index(get_context(), index, &volume, cb, userdata);
+        case SINK_INPUT:
+            return pa_context_set_sink_input_volume(get_context(), index, &volume, cb, userdata);
+        case SOURCE_OUTPUT:
+#if HAVE_SOURCE_OUTPUT_VOLUMES
+            return pa_context_set_source_output_volume(get_context(), index, &volume, cb, userdata);
+#else
+            return NULL;
+#endif
+        case EVENT_ROLE: {
+            RoleWidget *w = mpMainWindow->eventRoleWidget;
+            pa_ext_stream_restore_info info;
+
+            if (!w)
+                return NULL;
+
+            /* Written the way RoleWidget::executeVolumeUpdate() does it */
+            info.name = w->role.c_str();
+            info.channel_map.channels = 1;
+            info.channel_map.map[0] = PA_CHANNEL_POSITION_MONO;
+            info.volume = volume;
+            info.device = w->device == "" ? NULL : w->device.c_str();
+            info.mute = mute;
+
+            return pa_ext_stream_restore_write(get_context(), PA_UPDATE_REPLACE, &info, 1, TRUE, cb, userdata);
+        }
+    }
+
+    return NULL;
+}
+
+pa_operation* VolumeFader::setMute(Kind kind, uint32_t index, bool mute, const pa_cvolume &volume) {
+    pa_operation *o = NULL;
+
+    /* The role keeps volume and mute in one entry */
+    if (kind == EVENT_ROLE)
+        return setVolume(kind, index, volume, mute, NULL, NULL);
+
+    /* The object was muted at the volume it is restored to, so on unmute
+     * the volume has to be down before the mute is lifted */
+    if (!mute) {
+        if (!(o = setVolume(kind, index, volume, mute, NULL, NULL)))
+            return NULL;
+        pa_operation_unref(o);
+        o = NULL;
+    }
+
+    switch (kind) {
+        case SINK:
+            o = pa_context_set_sink_mute_by_index(get_context(), index, mute, NULL, NULL);
+            break;
+        case SOURCE:
+            o = pa_context_set_source_mute_by_index(get_context(), index, mute, NULL, NULL);
+            break;
+        case SINK_INPUT:
+            o = pa_context_set_sink_input_mute(get_context(), index, mute, NULL, NULL);
+            break;
+        case SOURCE_OUTPUT:
+#if HAVE_SOURCE_OUTPUT_VOLUMES
+            o = pa_context_set_source_output_mute(get_context(), index, mute, NULL, NULL);
+#endif
+            break;
+        case EVENT_ROLE:
+            break;
+    }
+
+    if (!o || !mute)
+        return o;
+
+    pa_operation_unref(o);
+    return setVolume(kind, index, volume, mute, NULL, NULL);
+}
+
+VolumeFader::Ramp* VolumeFader::start(Kind kind, uint32_t index, const pa_cvolume &from, const pa_cvolume &to, unsigned msec) {
+    RampKey key(kind, index);
+    std::map<RampKey, Ramp*>::iterator i;
+    Ramp *r = new Ramp;
+
+    if ((i = ramps.find(key)) != ramps.end())
+        drop(i->second);
+
+    r->fader = this;
+    r->kind = kind;
+    r->index = index;
+    r->from = r->sent = from;
+    r->to = to;
+    r->start = g_get_monotonic_time();
+    r->duration = (gint64) msec * 1000;
+    r->inFlight = r->last = r->cancelled = r->muteAtEnd = false;
+    r->ok = true;
+
+    ramps[key] = r;
+
+    if (!timerConnection.connected())
+        timerConnection = Glib::signal_timeout().connect(sigc::mem_fun(*this, &VolumeFader::onTick), FADE_INTERVAL_MSEC);
+
+    return r;
+}
+
+bool VolumeFader::fade(Kind kind, uint32_t index, const pa_cvolume &to, unsigned msec, const sigc::slot<void, bool> &done) {
+    pa_cvolume from, target;
+    Ramp *r;
+
+    if (!current(kind, index, &from) || !pa_cvolume_valid(&to))
+        return false;
+
+    /* A volume for fewer or more channels keeps the loudest one */
+    if (to.channels == from.channels)
+        target = to;
+    else
+        pa_cvolume_set(&target, from.channels, pa_cvolume_max(&to));
+
+    r = start(kind, index, from, target, msec);
+    r->done = done;
+
+    return true;
+}
+
+bool VolumeFader::fadeMute(Kind kind, uint32_t index, bool mute) {
+    std::map<RampKey, Ramp*>::iterator i;
+    pa_cvolume volume, from, silence;
+    pa_operation *o;
+    Ramp *r;
+
+    if (mMuteDuration == 0 || !current(kind, index, &volume))
+        return false;
+
+    from = volume;
+
+    if ((i = ramps.find(RampKey(kind, index))) != ramps.end()) {
+        Ramp *old = i->second;
+
+        /* Already fading out, the mute is on its way */
+        if (mute && old->muteAtEnd)
+            return true;
+
+        /* Unmuted before the fade-out finished, it turns around from
+         * where it got to */
+        if (!mute && old->muteAtEnd) {
+            from = old->sent;
+            volume = old->restore;
+            start(kind, index, from, volume, mMuteDuration);
+            return true;
+        }
+
+        /* Muted mid fade-in, it fades out from where it got to and
+         * goes back to the volume it was headed to */
+        from = old->sent;
+        volume = old->to;
+    }
+
+    pa_cvolume_mute(&silence, volume.channels);
+
+    if (mute) {
+        r = start(kind, index, from, silence, mMuteDuration);
+        r->muteAtEnd = true;
+        r->restore = volume;
+        return true;
+    }
+
+    /* Brought to silence, unmuted, then faded in */
+    if (!(o = setMute(kind, index, false, silence)))
+        return false;
+    pa_operation_unref(o);
+
+    start(kind, index, silence, volume, mMuteDuration);
+    return true;
+}
+
+bool VolumeFader::muting(Kind kind, uint32_t index) const {
+    std::map<RampKey, Ramp*>::const_iterator i = ramps.find(RampKey(kind, index));
+
+    return i != ramps.end() && i->second->muteAtEnd;
+}
+
+/* Takes the ramp out of the map, it is freed once no step is in flight */
+void VolumeFader::drop(Ramp *r) {
+    ramps.erase(RampKey(r->kind, r->index));
+    r->cancelled = true;
+
+    if (r->done)
+        r->done(false);
+
+    if (!r->inFlight)
+        delete r;
+}
+
+void VolumeFader::cancel(Kind kind, uint32_t index) {
+    std::map<RampKey, Ramp*>::iterator i = ramps.find(RampKey(kind, index));
+
+    if (i != ramps.end())
+        drop(i->second);
+}
+
+void VolumeFader::clear() {
+    while (!ramps.empty())
+        drop(ramps.begin()->second);
+}
+
+void VolumeFader::finish(Ramp *r) {
+    pa_operation *o;
+
+    ramps.erase(RampKey(r->kind, r->index));
+
+    if (r->ok && r->muteAtEnd) {
+        if ((o = setMute(r->kind, r->index, true, r->restore)))
+            pa_operation_unref(o);
+        else
+            r->ok = false;
+    }
+
+    if (r->done)
+        r->done(r->ok);
+
+    delete r;
+}
+
+bool VolumeFader::onTick() {
+    gint64 now = g_get_monotonic_time();
+    std::map<RampKey, Ramp*>::iterator i, next;
+
+    for (i = ramps.begin(); i != ramps.end(); i = next) {
+        Ramp *r = i->second;
+        pa_cvolume v;
+        pa_operation *o;
+        double p;
+
+        next = i;
+        ++next;
+
+        /* The previous step is still on its way, this one is coalesced
+         * into the next tick */
+        if (r->inFlight)
+            continue;
+
+        p = r->duration > 0 ? (double) (now - r->start) / r->duration : 1.0;
+
+        if (p >= 1.0)
+            v = r->to;
+        else {
+            v.channels = r->to.channels;
+            for (uint8_t c = 0; c < v.channels; c++) {
+                double from = fade_db(r->from.values[c]), to = fade_db(r->to.values[c]);
+                v.values[c] = pa_sw_volume_from_dB(from + (to - from) * p);
+            }
+        }
+
+        r->last = p >= 1.0;
+
+        if (!r->last && pa_cvolume_equal(&v, &r->sent))
+            continue;
+
+        r->sent = v;
+
+        if (!(o = setVolume(r->kind, r->index, v, false, step_cb, r))) {
+            r->ok = false;
+            finish(r);
+            continue;
+        }
+
+        r->inFlight = true;
+        pa_operation_unref(o);
+    }
+
+    return !ramps.empty();
+}
+
+void VolumeFader::step_cb(pa_context *, int success, void *userdata) {
+    Ramp *r = static_cast<Ramp*>(userdata);
+
+    r->inFlight = false;
+
+    if (r->cancelled) {
+        delete r;
+        return;
+    }
+
+    if (!success)
+        r->ok = false;
+
+    if (r->last || !r->ok)
+        r->fader->finish(r);
+}
@@ -0,0 +1,102 @@
+/***
+  This file is part of pavucontrol.
+
+  Copyright 2006-2008 Lennart Poettering
+  Copyright 2009 Colin Guthrie
+
+  pavucontrol is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol. If not, see <http://www.gnu.org/licenses/>.
+***/
+
+
+#ifndef volumefader_h
+#define volumefader_h
+
+#include <map>
+
+#include "pavucontrol.h"
+
+class MainWindow;
+
+/* Timed volume ramps, linear in dB. One timer advances all of them, and
+ * each object has at most one volume operation in flight, so a fade never
+ * sends more than one operation per object and tick however short it
+ * is. */
+class VolumeFader {
+public:
+    enum Kind {
+        SINK,
+        SOURCE,
+        SINK_INPUT,
+        SOURCE_OUTPUT,
+        EVENT_ROLE
+    };
+
+    VolumeFader(MainWindow *w);
+    ~VolumeFader();
+
+    /* How long the mute buttons fade, 0 makes them switch at once */
+    void setMuteDuration(unsigned msec) { mMuteDuration = msec; }
+    unsigned muteDuration() const { return mMuteDuration; }
+
+    /* done gets whether every step succeeded, a fade that is cancelled or
+     * replaced by another one did not */
+    bool fade(Kind kind, uint32_t index, const pa_cvolume &to, unsigned msec, const sigc::slot<void, bool> &done = sigc::slot<void, bool>());
+
+    /* Fades out before muting and in after unmuting. Returns false when
+     * the caller should just switch the mute. */
+    bool fadeMute(Kind kind, uint32_t index, bool mute);
+
+    /* Fading out towards a mute the server does not report yet */
+    bool muting(Kind kind, uint32_t index) const;
+
+    /* The user moved a slider, the ramp stops where it is */
+    void cancel(Kind kind, uint32_t index);
+    void clear();
+
+private:
+    typedef std::pair<int, uint32_t> RampKey;
+
+    struct Ramp {
+        VolumeFader *fader;
+        Kind kind;
+        uint32_t index;
+        pa_cvolume from, to, sent;
+        gint64 start, duration;
+        bool inFlight, last, ok, cancelled;
+
+        /* Fading out to mute, the volume goes back to this once muted */
+        bool muteAtEnd;
+        pa_cvolume restore;
+
+        sigc::slot<void, bool> done;
+    };
+
+    MainWindow *mpMainWindow;
+    unsigned mMuteDuration;
+    std::map<RampKey, Ramp*> ramps;
+    sigc::connection timerConnection;
+
+    bool current(Kind kind, uint32_t index, pa_cvolume *volume);
+    Ramp* start(Kind kind, uint32_t index, const pa_cvolume &from, const pa_cvolume &to, unsigned msec);
+    void drop(Ramp *r);
+    void finish(Ramp *r);
+
+    pa_operation* setVolume(Kind kind, uint32_t index, const pa_cvolume &volume, bool mute, pa_context_success_cb_t cb, void *userdata);
+    pa_operation* setMute(Kind kind, uint32_t index, bool mute, const pa_cvolume &volume);
+
+    bool onTick();
+    static void step_cb(pa_context *c, int success, void *userdata);
+};
+
+#endif